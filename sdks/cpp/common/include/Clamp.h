@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @brief Clamps arrays of numbers to a range.
+ * @file Clamp.h
+ * @copyright Copyright © 2024 Ross Video Ltd
+ */
+
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdint>
+#include <span>
+
+namespace catena {
+
+/**
+ * @brief Clamps each value to the range [lo, hi], in place.
+ *
+ * Uses AVX2 or SSE4.1 on x86 processors that support them, NEON on ARM, and
+ * a scalar loop otherwise.
+ *
+ * @param values in/out the values to clamp
+ * @param lo the lowest value allowed
+ * @param hi the highest value allowed, not less than lo
+ */
+void clamp(std::span<int32_t> values, int32_t lo, int32_t hi);
+
+/**
+ * @brief Clamps each value to the range [lo, hi], in place.
+ *
+ * NaNs are replaced by lo, on every processor.
+ *
+ * @param values in/out the values to clamp
+ * @param lo the lowest value allowed
+ * @param hi the highest value allowed, not less than lo
+ */
+void clamp(std::span<float> values, float lo, float hi);
+
+/**
+ * @brief Clamps a value to the range [lo, hi], with the same treatment of
+ * NaNs as the array overload.
+ *
+ * @param v the value to clamp
+ * @param lo the lowest value allowed
+ * @param hi the highest value allowed, not less than lo
+ * @return the clamped value
+ */
+inline float clamp(float v, float lo, float hi) {
+    v = v >= lo ? v : lo;
+    return v <= hi ? v : hi;
+}
+
+/**
+ * @brief Clamps a value to the range [lo, hi].
+ *
+ * @param v the value to clamp
+ * @param lo the lowest value allowed
+ * @param hi the highest value allowed, not less than lo
+ * @return the clamped value
+ */
+inline int32_t clamp(int32_t v, int32_t lo, int32_t hi) {
+    v = v >= lo ? v : lo;
+    return v <= hi ? v : hi;
+}
+
+}  // namespace catena
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mutex>
+#include <shared_mutex>
 
 namespace catena {
 namespace common {
@@ -9,6 +10,7 @@ namespace common {
  */
 struct FakeLock {
     FakeLock(std::mutex &) {}
+    FakeLock(std::shared_mutex &) {}
 };
 }  // namespace common
 }  // namespace catena 
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * @file ILanguagePack.h
+ * @brief Interface for language packs
+ * @copyright Copyright (c) 2024 Ross Video
+ */
+
+#include "google/protobuf/message_lite.h" 
+
+namespace catena {
+namespace common {
+
+/**
+ * @brief Interface for language packs
+ */
+class ILanguagePack {
+public:
+    ILanguagePack() = default;
+    ILanguagePack(ILanguagePack&&) = default;
+    ILanguagePack& operator=(ILanguagePack&&) = default;
+    virtual ~ILanguagePack() = default;
+
+    /**
+     * @brief serialize the language pack to a protobuf message
+     * @param pack the protobuf message to populate, NB, implementations should 
+     * dynamically cast this to catena::LanguagePack
+     */
+    virtual void toProto(google::protobuf::MessageLite& pack) const = 0;
+};
+
+} // namespace common
+} // namespace catena
@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * @file IMenuGroup.h
+ * @brief Interface for menu groups
+ * @copyright Copyright (c) 2024 Ross Video
+ */
+
+#include "google/protobuf/message_lite.h" 
+
+namespace catena {
+namespace common {
+
+/**
+ * @brief Interface for menu groups
+ */
+class IMenuGroup {
+public:
+    IMenuGroup() = default;
+    IMenuGroup(IMenuGroup&&) = default;
+    IMenuGroup& operator=(IMenuGroup&&) = default;
+    virtual ~IMenuGroup() = default;
+
+    /**
+     * @brief serialize the menu group to a protobuf message
+     * @param menuGroup the protobuf message to populate, NB, implementations should 
+     * dynamically cast this to catena::MenuGroup
+     */
+    virtual void toProto(google::protobuf::MessageLite& menuGroup) const = 0;
+};
+
+} // namespace common
+} // namespace catena
@@ -0,0 +1,99 @@
+#pragma once
+
+/**
+ * @brief A vector that keeps its first few elements inline.
+ * @file InlineVector.h
+ * @copyright Copyright © 2024 Ross Video Ltd
+ */
+
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace catena {
+namespace common {
+
+/**
+ * @brief A vector of up to N elements stored inline, that moves them all to
+ * the heap if it grows beyond that.
+ *
+ * Only what's needed by its users is implemented. It can be used in constant
+ * expressions, and a constexpr InlineVector can hold up to N elements.
+ *
+ * @tparam T the element type, which must be trivially copyable
+ * @tparam N the number of elements stored inline
+ */
+template <typename T, std::size_t N>
+class InlineVector {
+    static_assert(std::is_trivially_copyable_v<T>, "InlineVector elements must be trivially copyable");
+
+  public:
+    constexpr InlineVector() = default;
+
+    /**
+     * @brief append an element
+     * @param value the element to append
+     */
+    constexpr void push_back(const T& value) {
+        if (size_ < N) {
+            inline_[size_] = value;
+        } else {
+            if (size_ == N) {
+                heap_.assign(inline_.begin(), inline_.end());
+            }
+            heap_.push_back(value);
+        }
+        ++size_;
+    }
+
+    /**
+     * @brief the element at index i, which must be less than size()
+     */
+    constexpr T& operator[](std::size_t i) { return size_ <= N ? inline_[i] : heap_[i]; }
+
+    /**
+     * @brief the element at index i, which must be less than size()
+     */
+    constexpr const T& operator[](std::size_t i) const { return size_ <= N ? inline_[i] : heap_[i]; }
+
+    /**
+     * @brief the number of elements
+     */
+    constexpr std::size_t size() const { return size_; }
+
+    /**
+     * @brief are there no elements
+     */
+    constexpr bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief remove every element
+     */
+    constexpr void clear() {
+        heap_.clear();
+        size_ = 0;
+    }
+
+  private:
+    std::array<T, N> inline_{};
+    std::vector<T> heap_{};
+    std::size_t size_ = 0;
+};
+
+}  // namespace common
+}  // namespace catena
@@ -26,31 +26,135 @@
 //
 
 
+#include <common/include/InlineVector.h>
+
+#include <array>
+#include <cstddef>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <string>
-#include <deque>
+#include <string_view>
+#include <utility>
 #include <variant>
-#include <memory>
+#include <vector>
 
 namespace catena {
 namespace common {
+
+namespace detail {
+/**
+ * @brief where a segment's unescaped text is in its path's text, and the
+ * index it's decoded to if it's an array index
+ */
+struct PathSegment {
+    std::size_t offset;
+    std::size_t length;
+    std::size_t index;
+    bool isIndex;
+};
+
+/**
+ * @brief the segments of a path, most paths are short enough to be inline
+ */
+using PathSegments = InlineVector<PathSegment, 8>;
+
+constexpr bool isPathDigit(char c) { return c >= '0' && c <= '9'; }
+
+constexpr bool isPathWordChar(char c) {
+    return isPathDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+/**
+ * @brief split a json-pointer into segments in a single pass
+ *
+ * Segments may contain letters, digits, underscores and the escapes "~0" and
+ * "~1", or be "-", which is the one-past-the-end array index. Segments of
+ * digits are decoded to array indices.
+ *
+ * @param path the escaped json-pointer
+ * @param segments out the segments found
+ * @param append called with each character of the segments' unescaped text,
+ * which the segments' offsets refer to
+ * @return nullptr if path is valid, or why it isn't
+ */
+template <typename Append>
+constexpr const char* parsePath(std::string_view path, PathSegments& segments, Append&& append) {
+    constexpr std::size_t kEnd = std::size_t(-1);
+    if (path.empty()) {
+        return "path is empty";
+    }
+    if (path[0] != '/') {
+        return "path must start with '/'";
+    }
+    std::size_t n = 0;  // characters appended so far
+    std::size_t i = 0;
+    while (i < path.size()) {
+        ++i;  // skip the solidus
+        PathSegment segment{n, 0, 0, false};
+        if (i < path.size() && path[i] == '-' && (i + 1 == path.size() || path[i + 1] == '/')) {
+            append('-');
+            ++n;
+            ++i;
+            segment = PathSegment{segment.offset, 1, kEnd, true};
+        } else {
+            bool digits = true;
+            bool overflow = false;
+            for (; i < path.size() && path[i] != '/'; ++i, ++n) {
+                const char c = path[i];
+                if (c == '~') {
+                    if (i + 1 == path.size() || (path[i + 1] != '0' && path[i + 1] != '1')) {
+                        return "'~' must be followed by '0' or '1'";
+                    }
+                    append(path[++i] == '0' ? '~' : '/');
+                    digits = false;
+                } else if (isPathWordChar(c)) {
+                    append(c);
+                    if (digits && isPathDigit(c)) {
+                        const std::size_t d = c - '0';
+                        if (segment.index > (kEnd - 1 - d) / 10) {
+                            overflow = true;
+                        } else {
+                            segment.index = segment.index * 10 + d;
+                        }
+                    } else {
+                        digits = false;
+                    }
+                } else {
+                    return "segments may only contain letters, digits, '_', \"~0\" and \"~1\"";
+                }
+            }
+            segment.length = n - segment.offset;
+            segment.isIndex = digits && segment.length > 0;
+            if (segment.isIndex && overflow) {
+                return "index is too large";
+            }
+            if (!segment.isIndex) {
+                segment.index = 0;
+            }
+        }
+        segments.push_back(segment);
+    }
+    return nullptr;
+}
+}  // namespace detail
+
 /**
  * @brief Handles Path objects used to uniquely identify and access OIDs
  *
+ * The path is parsed once, when it's constructed. Its segments' unescaped
+ * text is kept in one string, and array indices are decoded as they're
+ * parsed, so reading the segments copies and converts nothing. The _path
+ * literal parses paths at compile time.
  */
 class Path {
   public:
-    /**
-     * @brief what we split the path into
-     *
-     */
-    using Segments = std::deque<std::string>;
-
     /**
      * @brief type of index path segments
      *
      */
-    using Index = Segments::size_type;
+    using Index = std::size_t;
 
     /**
      * @brief used to signal one-past-the-end array size
@@ -63,8 +167,10 @@ class Path {
      * or array indices (std::size_t). The "one past the end" index
      * is flagged by the value kEnd.
      *
+     * Oids refer to the path's own copy of them, so they're valid until the
+     * path is destroyed or added to.
      */
-    using Segment = typename std::variant<Index, std::string>;
+    using Segment = typename std::variant<Index, std::string_view>;
 
 
     Path() = default;
@@ -81,36 +187,46 @@ class Path {
      * i.e. '/' replaced by "~1" and '~' by "~0"
      * @throw catena::exception_with_status INVALID_ARGUMENT if path is not a valid json-pointer
      */
-    explicit Path(const std::string& path);
+    explicit Path(std::string_view path);
 
     /**
-     * @brief Construct a new Path object
+     * @brief Construct a new Path object.
      *
-     * @param literal an escaped json-pointer,
+     * @param path an escaped json-pointer,
      * i.e. '/' replaced by "~1" and '~' by "~0"
+     * @throw catena::exception_with_status INVALID_ARGUMENT if path is not a valid json-pointer
      */
-    explicit Path(const char* literal);
+    explicit Path(const std::string& path) : Path(std::string_view{path}) {}
 
     /**
-     * @brief iterator to the start of our segmented Path.
+     * @brief Construct a new Path object
      *
-     * @return std::vector::iterator
+     * @param literal an escaped json-pointer,
+     * i.e. '/' replaced by "~1" and '~' by "~0"
      */
-    inline Segments::iterator begin() { return segments_.begin(); }
+    explicit Path(const char* literal) : Path(std::string_view{literal}) {}
 
     /**
-     * @brief iterator to the end of our segmented Path.
+     * @brief Construct a Path from a json-pointer parsed at compile time, as
+     * the _path literal does.
      *
-     * @return std::vector::iterator
+     * @param segments the path's segments, which must outlive the Path
+     * @param text the unescaped text of the segments, which must outlive the Path
      */
-    inline Segments::iterator end() { return segments_.end(); }
+    constexpr Path(std::span<const detail::PathSegment> segments, std::string_view text)
+        : literalSegments_{segments}, literalText_{text}, literal_{true} {}
 
     /**
      * @brief return the number of segments in the Path
      *
      * @return number of segments
      */
-    inline Index size() const { return segments_.size(); }
+    constexpr Index size() const { return count_() - front_; }
+
+    /**
+     * @brief are there no segments left in the path
+     */
+    constexpr bool empty() const { return size() == 0; }
 
     /**
      * @brief take the front off the path and return it.
@@ -120,7 +236,13 @@ class Path {
      * Will be empty string if nothing to pop, or the original path
      * was "/", or "".
      */
-    Segment pop_front() noexcept;
+    constexpr Segment pop_front() noexcept {
+        Segment ans = front();
+        if (front_ < count_()) {
+            ++front_;
+        }
+        return ans;
+    }
 
     /**
      * @brief return the front of the path.
@@ -129,42 +251,121 @@ class Path {
      * or an array index.
      * Will be empty string if path is "/", or "".
      */
-    Segment front() noexcept;
+    constexpr Segment front() const noexcept {
+        if (empty()) {
+            return std::string_view{};
+        }
+        const detail::PathSegment& segment = segment_(front_);
+        if (segment.isIndex) {
+            return segment.index;
+        }
+        return text_().substr(segment.offset, segment.length);
+    }
 
     /**
-     * @brief escapes the oid then adds it to the end of the path.
+     * @brief adds the oid to the end of the path.
      *
-     * @param oid
+     * @param oid the unescaped oid
      */
-    void push_back(const std::string& oid);
+    void push_back(std::string_view oid);
 
     /**
      * @brief return a fully qualified, albeit escaped oid
      *
      * @return std::string
      */
-    std::string fqoid();
+    std::string fqoid() const;
 
   private:
-    Segments segments_; /**< the path split into its components */
+    /**
+     * @brief is the path a literal's, parsed at compile time
+     */
+    constexpr bool isLiteral_() const { return literal_; }
 
     /**
-     * @brief replace / and ~ characters with ~1 & ~0
-     *
-     * @param str in|out
+     * @brief the number of segments, including those popped
      */
-    void escape(std::string& str);
+    constexpr std::size_t count_() const { return isLiteral_() ? literalSegments_.size() : segments_.size(); }
 
     /**
-     * @brief replace ~0 and ~1 with ~ and /
-     *
-     * @param str
-     * @return unescaped version of str
+     * @brief the segment at index i, counting those popped
+     */
+    constexpr const detail::PathSegment& segment_(std::size_t i) const {
+        return isLiteral_() ? literalSegments_[i] : segments_[i];
+    }
+
+    /**
+     * @brief the unescaped text of the segments
      */
-    std::string unescape(const std::string& str);
+    constexpr std::string_view text_() const {
+        return isLiteral_() ? literalText_ : std::string_view{storage_.data(), storage_.size()};
+    }
+
+    detail::PathSegments segments_;                         /**< the path split into its components */
+    std::vector<char> storage_;                             /**< the segments' text */
+    std::span<const detail::PathSegment> literalSegments_;  /**< the segments, if the path is a literal's */
+    std::string_view literalText_;                          /**< the segments' text, if the path is a literal's */
+    bool literal_ = false;                                  /**< is the path a literal's */
+    std::size_t front_ = 0;                                 /**< the number of segments popped */
+};
+
+namespace detail {
+/**
+ * @brief a string literal used as a template argument
+ */
+template <std::size_t N>
+struct PathLiteral {
+    char chars[N]{};
+    consteval PathLiteral(const char (&literal)[N]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            chars[i] = literal[i];
+        }
+    }
+    constexpr std::string_view view() const { return {chars, N - 1}; }
+};
+
+/**
+ * @brief the path literal S, parsed
+ */
+template <PathLiteral S>
+struct ParsedPathLiteral {
+    static constexpr std::size_t count = [] {
+        PathSegments segments;
+        if (parsePath(S.view(), segments, [](char) {}) != nullptr) {
+            throw "not a valid path";
+        }
+        return segments.size();
+    }();
+
+    static constexpr auto segments = [] {
+        std::array<PathSegment, count> ans{};
+        PathSegments segments;
+        parsePath(S.view(), segments, [](char) {});
+        for (std::size_t i = 0; i < count; ++i) {
+            ans[i] = segments[i];
+        }
+        return ans;
+    }();
+
+    static constexpr auto text = [] {
+        std::pair<std::array<char, sizeof(S.chars)>, std::size_t> ans{};
+        PathSegments segments;
+        parsePath(S.view(), segments, [&ans](char c) { ans.first[ans.second++] = c; });
+        return ans;
+    }();
 };
+}  // namespace detail
 
-}  // namespace full
+}  // namespace common
 }  // namespace catena
 
-catena::common::Path operator"" _path(const char* lit, std::size_t sz);
+/**
+ * @brief a Path parsed at compile time, e.g. "/a/b/3"_path
+ *
+ * Invalid paths don't compile.
+ */
+template <catena::common::detail::PathLiteral S>
+consteval catena::common::Path operator""_path() {
+    using Parsed = catena::common::detail::ParsedPathLiteral<S>;
+    return catena::common::Path{Parsed::segments, std::string_view{Parsed::text.first.data(), Parsed::text.second}};
+}
@@ -0,0 +1,162 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <common/include/Clamp.h>
+
+#include <cstddef>
+
+// x86 builds don't assume the vector extensions are present. They're compiled
+// in regardless and chosen when first used, so one binary runs everywhere.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CATENA_CLAMP_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CATENA_CLAMP_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+template <typename T>
+void clampScalar(T* p, std::size_t n, T lo, T hi) {
+    for (std::size_t i = 0; i < n; ++i) {
+        p[i] = catena::clamp(p[i], lo, hi);
+    }
+}
+
+#if defined(CATENA_CLAMP_X86)
+
+// max(v, lo) yields lo when v is NaN, min(v, hi) then leaves it there
+
+__attribute__((target("avx2")))
+void clampAvx2(int32_t* p, std::size_t n, int32_t lo, int32_t hi) {
+    const __m256i vlo = _mm256_set1_epi32(lo);
+    const __m256i vhi = _mm256_set1_epi32(hi);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        v = _mm256_min_epi32(_mm256_max_epi32(v, vlo), vhi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), v);
+    }
+    clampScalar(p + i, n - i, lo, hi);
+}
+
+__attribute__((target("avx2")))
+void clampAvx2(float* p, std::size_t n, float lo, float hi) {
+    const __m256 vlo = _mm256_set1_ps(lo);
+    const __m256 vhi = _mm256_set1_ps(hi);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(p + i);
+        v = _mm256_min_ps(_mm256_max_ps(v, vlo), vhi);
+        _mm256_storeu_ps(p + i, v);
+    }
+    clampScalar(p + i, n - i, lo, hi);
+}
+
+__attribute__((target("sse4.1")))
+void clampSse41(int32_t* p, std::size_t n, int32_t lo, int32_t hi) {
+    const __m128i vlo = _mm_set1_epi32(lo);
+    const __m128i vhi = _mm_set1_epi32(hi);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        v = _mm_min_epi32(_mm_max_epi32(v, vlo), vhi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), v);
+    }
+    clampScalar(p + i, n - i, lo, hi);
+}
+
+__attribute__((target("sse4.1")))
+void clampSse41(float* p, std::size_t n, float lo, float hi) {
+    const __m128 vlo = _mm_set1_ps(lo);
+    const __m128 vhi = _mm_set1_ps(hi);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(p + i);
+        v = _mm_min_ps(_mm_max_ps(v, vlo), vhi);
+        _mm_storeu_ps(p + i, v);
+    }
+    clampScalar(p + i, n - i, lo, hi);
+}
+
+template <typename T>
+using ClampFn = void (*)(T*, std::size_t, T, T);
+
+/**
+ * @brief pick the widest implementation the processor supports
+ */
+template <typename T>
+ClampFn<T> select() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return &clampAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return &clampSse41;
+    }
+    return &clampScalar<T>;
+}
+
+#elif defined(CATENA_CLAMP_NEON)
+
+void clampNeon(int32_t* p, std::size_t n, int32_t lo, int32_t hi) {
+    const int32x4_t vlo = vdupq_n_s32(lo);
+    const int32x4_t vhi = vdupq_n_s32(hi);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v = vld1q_s32(p + i);
+        v = vminq_s32(vmaxq_s32(v, vlo), vhi);
+        vst1q_s32(p + i, v);
+    }
+    clampScalar(p + i, n - i, lo, hi);
+}
+
+void clampNeon(float* p, std::size_t n, float lo, float hi) {
+    const float32x4_t vlo = vdupq_n_f32(lo);
+    const float32x4_t vhi = vdupq_n_f32(hi);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // vmaxq_f32 propagates NaNs, selecting on the comparisons doesn't
+        float32x4_t v = vld1q_f32(p + i);
+        v = vbslq_f32(vcgeq_f32(v, vlo), v, vlo);
+        v = vbslq_f32(vcleq_f32(v, vhi), v, vhi);
+        vst1q_f32(p + i, v);
+    }
+    clampScalar(p + i, n - i, lo, hi);
+}
+
+#endif
+
+template <typename T>
+void clampArray(T* p, std::size_t n, T lo, T hi) {
+#if defined(CATENA_CLAMP_X86)
+    static const ClampFn<T> impl = select<T>();
+    impl(p, n, lo, hi);
+#elif defined(CATENA_CLAMP_NEON)
+    clampNeon(p, n, lo, hi);
+#else
+    clampScalar(p, n, lo, hi);
+#endif
+}
+
+}  // namespace
+
+void catena::clamp(std::span<int32_t> values, int32_t lo, int32_t hi) {
+    clampArray(values.data(), values.size(), lo, hi);
+}
+
+void catena::clamp(std::span<float> values, float lo, float hi) {
+    clampArray(values.data(), values.size(), lo, hi);
+}
@@ -13,107 +13,52 @@
 //
 
 #include <common/include/Path.h>
-#include <common/include/utils.h>
 #include <common/include/Status.h>
 
-#include <regex>
+#include <sstream>
 
 using catena::common::Path;
 
-Path::Path(const std::string &path) : segments_{} {
-    // regex will split a well-formed json pointer into a sequence of strings
-    // that all start with the solidus '/' character and contain these matches:
-    // /- -- can be used as an array index
-    // /any_string_that_uses_only_word_chars -- i.e. letters & underscores.
-    // /string_with_~0_~1_escaped_chars -- string_with_~_/_escaped_chars
-    // /291834719 -- just numbers
-    //
-
-    if (path.empty()) {
-        std::stringstream why;
-        why << __PRETTY_FUNCTION__ << "\npath is empty";
-        throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
-    }
-
-    std::regex path_regex("((\\/-{1})|(\\/([\\w]|~[01])*))*");
-    if (!std::regex_match(path, path_regex))  {
+Path::Path(std::string_view path) : segments_{}, storage_{}, literalSegments_{}, literalText_{}, literal_{false}, front_{0} {
+    // the unescaped text is never longer than the path
+    storage_.reserve(path.size());
+    const char* err = detail::parsePath(path, segments_, [this](char c) { storage_.push_back(c); });
+    if (err != nullptr) {
         std::stringstream why;
-        why << __PRETTY_FUNCTION__ << "\n'" << path << "' is not a valid path";
+        why << __PRETTY_FUNCTION__ << "\n'" << path << "' is not a valid path, " << err;
         throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
     }
+}
 
-    std::regex segment_regex("(\\/-{1})|(\\/([\\w]|~[01])*)");
-    auto r_begin = std::sregex_iterator(path.begin(), path.end(), segment_regex);
-    auto r_end = std::sregex_iterator();
-    for (std::sregex_iterator it = r_begin; it != r_end; ++it) {
-        std::smatch match = *it;
-        if (it == r_begin && match.position(0) != 0) {
-            std::stringstream why;
-            why << __PRETTY_FUNCTION__ << "\n'" << path << " is invalid json pointer";
-            throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
+void Path::push_back(std::string_view oid) {
+    if (isLiteral_()) {
+        // literals are immutable, so take a copy to add to
+        for (const detail::PathSegment& segment : literalSegments_) {
+            segments_.push_back(segment);
         }
-
-        std::string txt = unescape(match.str());
-        // strip off the leading solidus '/'
-        segments_.push_back(txt.substr(1, std::string::npos));
+        storage_.assign(literalText_.begin(), literalText_.end());
+        literalSegments_ = {};
+        literalText_ = {};
+        literal_ = false;
     }
+    segments_.push_back(detail::PathSegment{storage_.size(), oid.size(), 0, false});
+    storage_.insert(storage_.end(), oid.begin(), oid.end());
 }
 
-Path::Path(const char *literal) : Path(std::string(literal)) {}
-
-Path::Segment Path::pop_front() noexcept {
-    Segment ans = front();
-    segments_.pop_front();
-    return ans;
-}
-
-Path::Segment Path::front() noexcept {
-    Segment ans;
-    if (segments_.size() >= 1) {
-        std::string seg = segments_[0];
-        if (seg.compare("-") == 0) {
-            // the one-past-the-end array index
-            ans.emplace<Index>(kEnd);
-        } else if (std::all_of(seg.begin(), seg.end(), ::isdigit)) {
-            // segment is all digits, so convert to Index
-            ans.emplace<Index>(std::stoul(seg));
-        } else {
-            // segment is a string
-            ans.emplace<std::string>(seg);
+std::string Path::fqoid() const {
+    std::string ans;
+    for (std::size_t i = front_; i < count_(); ++i) {
+        const detail::PathSegment& segment = segment_(i);
+        ans += '/';
+        for (char c : text_().substr(segment.offset, segment.length)) {
+            if (c == '~') {
+                ans += "~0";
+            } else if (c == '/') {
+                ans += "~1";
+            } else {
+                ans += c;
+            }
         }
-    } else {
-        // return empty string
-        ans.emplace<std::string>("");
     }
     return ans;
 }
-
-void Path::escape(std::string &str) {
-    subs(str, "~", "~0");
-    subs(str, "/", "~1");
-}
-
-std::string Path::unescape(const std::string &str) {
-    std::string ans(str);
-    subs(ans, "~0", "~");
-    subs(ans, "~1", "/");
-    return ans;
-}
-
-void Path::push_back(const std::string &oid) {
-    std::string back{oid};
-    escape(back);
-    segments_.push_back(back);
-}
-
-std::string Path::fqoid() {
-    std::stringstream ans{""};
-    for (auto it = segments_.begin(); it != segments_.end(); ++it) {
-        ans << '/' << *it;
-    }
-    return ans.str();
-}
-
-Path operator"" _path(const char *lit, std::size_t sz) {
-    return Path(lit);
-}
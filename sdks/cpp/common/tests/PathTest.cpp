@@ -0,0 +1,196 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include <common/include/InlineVector.h>
+#include <common/include/Path.h>
+#include <common/include/Status.h>
+
+#include <string>
+#include <string_view>
+
+using catena::common::InlineVector;
+using catena::common::Path;
+using Index = Path::Index;
+
+namespace {
+
+/**
+ * @brief the oid at the front of path
+ */
+std::string_view frontOid(const Path& path) { return std::get<std::string_view>(path.front()); }
+
+/**
+ * @brief the index at the front of path
+ */
+Index frontIndex(const Path& path) { return std::get<Index>(path.front()); }
+
+/**
+ * @brief expect path to be rejected as INVALID_ARGUMENT
+ */
+void expectInvalid(const std::string& path) {
+    try {
+        Path p(path);
+        ADD_FAILURE() << "'" << path << "' was accepted";
+    } catch (const catena::exception_with_status& why) {
+        EXPECT_EQ(why.status, catena::StatusCode::INVALID_ARGUMENT) << path;
+    }
+}
+
+/**
+ * @brief expect two paths to have the same segments
+ */
+void expectSameSegments(Path a, Path b) {
+    ASSERT_EQ(a.size(), b.size());
+    while (!a.empty()) {
+        EXPECT_EQ(a.pop_front(), b.pop_front());
+    }
+}
+
+constexpr Path kLiteral = "/a~1b/12/-/c_d"_path;
+static_assert(kLiteral.size() == 4, "literals are parsed at compile time");
+
+}  // namespace
+
+TEST(PathTest, RootIsOneEmptySegment) {
+    Path p("/");
+    EXPECT_EQ(p.size(), 1u);
+    EXPECT_EQ(frontOid(p), "");
+    EXPECT_EQ(p.fqoid(), "/");
+}
+
+TEST(PathTest, TrailingSolidusAddsEmptySegment) {
+    Path p("/a/b/");
+    ASSERT_EQ(p.size(), 3u);
+    EXPECT_EQ(std::get<std::string_view>(p.pop_front()), "a");
+    EXPECT_EQ(std::get<std::string_view>(p.pop_front()), "b");
+    EXPECT_EQ(frontOid(p), "");
+    p.pop_front();
+    EXPECT_TRUE(p.empty());
+    // popping an empty path leaves it empty
+    EXPECT_EQ(std::get<std::string_view>(p.pop_front()), "");
+    EXPECT_TRUE(p.empty());
+}
+
+TEST(PathTest, Escapes) {
+    Path p("/x~0y/~1z/~0~1");
+    EXPECT_EQ(std::get<std::string_view>(p.pop_front()), "x~y");
+    EXPECT_EQ(std::get<std::string_view>(p.pop_front()), "/z");
+    EXPECT_EQ(frontOid(p), "~/");
+    EXPECT_EQ(Path("/x~0y/~1z/~0~1").fqoid(), "/x~0y/~1z/~0~1");
+    // an escaped digit segment is an oid, not an index
+    EXPECT_EQ(frontOid(Path("/1~02")), "1~2");
+    expectInvalid("/~");
+    expectInvalid("/~2");
+    expectInvalid("/a~");
+}
+
+TEST(PathTest, OnePastTheEnd) {
+    Path p("/a/-");
+    p.pop_front();
+    EXPECT_EQ(frontIndex(p), Path::kEnd);
+    EXPECT_EQ(Path("/a/-").fqoid(), "/a/-");
+    expectInvalid("/-x");
+    expectInvalid("/x-");
+}
+
+TEST(PathTest, Indices) {
+    EXPECT_EQ(frontIndex(Path("/0")), 0u);
+    EXPECT_EQ(frontIndex(Path("/42")), 42u);
+    EXPECT_EQ(frontIndex(Path("/007")), 7u);
+    EXPECT_EQ(Path("/007").fqoid(), "/007");
+    EXPECT_EQ(frontOid(Path("/12ab")), "12ab");
+}
+
+TEST(PathTest, IndexOverflow) {
+    // the largest index, kEnd - 1, is accepted; kEnd and beyond aren't
+    EXPECT_EQ(frontIndex(Path("/" + std::to_string(Path::kEnd - 1))), Path::kEnd - 1);
+    expectInvalid("/" + std::to_string(Path::kEnd));
+    expectInvalid("/99999999999999999999999");
+    // a long run of digits that isn't all digits is an oid
+    EXPECT_EQ(frontOid(Path("/99999999999999999999999abc")), "99999999999999999999999abc");
+}
+
+TEST(PathTest, Invalid) {
+    expectInvalid("");
+    expectInvalid("a");
+    expectInvalid("/a b");
+    expectInvalid("/a.b");
+}
+
+TEST(PathTest, LiteralMatchesRuntime) {
+    expectSameSegments(kLiteral, Path("/a~1b/12/-/c_d"));
+    expectSameSegments("/"_path, Path("/"));
+    expectSameSegments("/a/b/"_path, Path("/a/b/"));
+    expectSameSegments("/~0~1/-/007"_path, Path("/~0~1/-/007"));
+    EXPECT_EQ(kLiteral.fqoid(), "/a~1b/12/-/c_d");
+}
+
+TEST(PathTest, PushBackOnLiteral) {
+    Path p = kLiteral;
+    p.pop_front();
+    p.push_back("new/oid");
+    EXPECT_EQ(p.fqoid(), "/12/-/c_d/new~1oid");
+    ASSERT_EQ(p.size(), 4u);
+    EXPECT_EQ(frontIndex(p), 12u);
+    // the literal itself is unchanged
+    EXPECT_EQ(kLiteral.fqoid(), "/a~1b/12/-/c_d");
+}
+
+TEST(PathTest, GrowsPastInlineSegments) {
+    std::string text;
+    for (int i = 0; i < 20; ++i) {
+        text += "/" + std::to_string(i);
+    }
+    Path p(text);
+    ASSERT_EQ(p.size(), 20u);
+    p.push_back("tail");
+    for (Index i = 0; i < 20; ++i) {
+        EXPECT_EQ(std::get<Index>(p.pop_front()), i);
+    }
+    EXPECT_EQ(frontOid(p), "tail");
+
+    Path literal = "/a/b/c/d/e/f/g/h/i/j"_path;
+    literal.push_back("k");
+    EXPECT_EQ(literal.size(), 11u);
+    EXPECT_EQ(literal.fqoid(), "/a/b/c/d/e/f/g/h/i/j/k");
+}
+
+TEST(InlineVectorTest, GrowsPastInlineElements) {
+    InlineVector<int, 4> v;
+    EXPECT_TRUE(v.empty());
+    for (int i = 0; i < 10; ++i) {
+        v.push_back(i);
+        ASSERT_EQ(v.size(), static_cast<std::size_t>(i + 1));
+        for (int j = 0; j <= i; ++j) {
+            EXPECT_EQ(v[j], j);
+        }
+    }
+    v.clear();
+    EXPECT_TRUE(v.empty());
+    v.push_back(7);
+    EXPECT_EQ(v[0], 7);
+}
+
+TEST(InlineVectorTest, UsableInConstantExpressions) {
+    constexpr auto v = [] {
+        InlineVector<int, 4> ans;
+        ans.push_back(1);
+        ans.push_back(2);
+        return ans;
+    }();
+    static_assert(v.size() == 2 && v[1] == 2);
+    EXPECT_EQ(v[0], 1);
+}
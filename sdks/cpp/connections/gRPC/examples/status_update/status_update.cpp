@@ -4,6 +4,7 @@
 
 #include <lite/include/Device.h>
 #include <lite/include/Param.h>
+#include <lite/include/WriteAheadLog.h>
 
 #include <connections/gRPC/include/ServiceImpl.h>
 
@@ -42,6 +43,7 @@ ABSL_FLAG(std::string, secure_comms, "off", "Specify type of secure comms, optio
 ABSL_FLAG(bool, mutual_authc, false, "use this to require client to authenticate");
 ABSL_FLAG(bool, authz, false, "use OAuth token authorization");
 ABSL_FLAG(std::string, static_root, getenv("HOME"), "Specify the directory to search for external objects");
+ABSL_FLAG(std::string, wal_dir, "", "Directory in which to journal client changes, leave empty to disable");
 
 Server *globalServer = nullptr;
 std::atomic<bool> globalLoop = true;
@@ -124,10 +126,10 @@ void statusUpdateExample(){
         while (globalLoop) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
             {
-                Device::LockGuard lg(dm); 
-                aNumber.get()++;
-                std::cout << aNumber.getOid() << " set to " << aNumber.get() << '\n';
-                dm.valueSetByServer.emit("/counter", &aNumber, 0);
+                // locks the device, and notifies the clients when it goes out of scope
+                auto counter = aNumber.update();
+                ++*counter;
+                std::cout << aNumber.getOid() << " set to " << *counter << '\n';
             }
         }
     });
@@ -156,6 +158,12 @@ void RunRPCServer(std::string addr)
         builder.AddListeningPort(addr, getServerCredentials());
         std::unique_ptr<grpc::ServerCompletionQueue> cq = builder.AddCompletionQueue();
         std::string EOPath = absl::GetFlag(FLAGS_static_root);
+
+        // restore and then journal values set by clients, if asked to
+        std::unique_ptr<WriteAheadLog> wal;
+        if (!absl::GetFlag(FLAGS_wal_dir).empty()) {
+            wal = std::make_unique<WriteAheadLog>(dm, absl::GetFlag(FLAGS_wal_dir));
+        }
         CatenaServiceImpl service(cq.get(), dm, EOPath);
 
         builder.RegisterService(&service);
@@ -12,6 +12,13 @@
 
 #include <condition_variable>
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 using grpc::ServerContext;
 using grpc::ServerAsyncWriter;
@@ -30,14 +37,60 @@ public:
 
 class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
   public:
+    /**
+     * @brief the devices hosted by a service, each must occupy a unique slot
+     */
+    using Devices = std::vector<std::reference_wrapper<Device>>;
+
+    /**
+     * @brief routes a slot number to the device that occupies it
+     */
+    using SlotMap = std::map<uint32_t, Device*>;
+
+  public:
+    /**
+     * @brief Construct a service that hosts a single device
+     * @param cq the completion queue to serve requests on
+     * @param dm the device, requests must address its slot
+     * @param EOPath root directory of the external objects
+     */
     CatenaServiceImpl(ServerCompletionQueue* cq, Device &dm, std::string& EOPath);
 
+    /**
+     * @brief Construct a service that hosts several devices, one per slot.
+     * GetValue, SetValue and DeviceRequest are routed by the slot in the
+     * request, Connect streams push updates from every hosted device.
+     * @param cq the completion queue to serve requests on
+     * @param dms the devices to host
+     * @param EOPath root directory of the external objects
+     * @throws catena::exception_with_status INVALID_ARGUMENT if dms is empty or two devices share a slot
+     */
+    CatenaServiceImpl(ServerCompletionQueue* cq, const Devices& dms, std::string& EOPath);
+
+    /**
+     * @brief Destroy the service, disconnecting it from the hosted devices
+     */
+    ~CatenaServiceImpl();
+
     void init();
 
     void processEvents();
 
     void shutdownServer();
 
+    /**
+     * @brief get the device in a slot
+     * @param slot the slot addressed by the request
+     * @return the device occupying the slot
+     * @throws catena::exception_with_status NOT_FOUND if the slot is empty
+     */
+    Device& dm(uint32_t slot) const;
+
+    /**
+     * @brief get the hosted devices, ordered by slot
+     */
+    inline const SlotMap& slots() const { return dms_; }
+
     /**
      * Nested private classes
      */
@@ -60,9 +113,15 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
     std::mutex registryMutex_;
 
     ServerCompletionQueue* cq_;
-    Device &dm_;
+    SlotMap dms_;
     std::string& EOPath_;
 
+    /**
+     * @brief an update pushed to clients. It's immutable so that every
+     * client's queue can share it.
+     */
+    using Update = std::shared_ptr<const catena::PushUpdates>;
+
   public:
 
     void registerItem(CallData *cd);
@@ -73,7 +132,7 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
 
     class GetPopulatedSlots : public CallData{
         public:
-        GetPopulatedSlots(CatenaServiceImpl *service, Device &dm, bool ok);
+        GetPopulatedSlots(CatenaServiceImpl *service, bool ok);
 
         void proceed(CatenaServiceImpl *service, bool ok) override;
 
@@ -84,14 +143,13 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
         catena::SlotList res_;
         ServerAsyncResponseWriter<::catena::SlotList> responder_;
         CallStatus status_;
-        Device &dm_;
         int objectId_;
         static int objectCounter_;
     };
 
     class GetValue : public CallData{
         public:
-        GetValue(CatenaServiceImpl *service, Device &dm, bool ok);
+        GetValue(CatenaServiceImpl *service, bool ok);
 
         void proceed(CatenaServiceImpl *service, bool ok) override;
 
@@ -103,7 +161,6 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
         catena::Value res_;
         ServerAsyncResponseWriter<::catena::Value> responder_;
         CallStatus status_;
-        Device &dm_;
         int objectId_;
         static int objectCounter_;
     };
@@ -113,7 +170,7 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
      */
     class SetValue : public CallData {
       public:
-        SetValue(CatenaServiceImpl *service, Device &dm, bool ok);
+        SetValue(CatenaServiceImpl *service, bool ok);
 
         void proceed(CatenaServiceImpl *service, bool ok) override;
 
@@ -124,7 +181,6 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
         catena::Value res_;
         ServerAsyncResponseWriter<::google::protobuf::Empty> responder_;
         CallStatus status_;
-        Device &dm_;
         Status errorStatus_;
         int objectId_;
         static int objectCounter_;
@@ -135,26 +191,38 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
      */
     class Connect : public CallData {
       public:
-        Connect(CatenaServiceImpl *service, Device &dm, bool ok);
+        Connect(CatenaServiceImpl *service, bool ok);
 
         void proceed(CatenaServiceImpl *service, bool ok) override;
 
+        /**
+         * @brief queue an update for this client
+         * @param update the update, shared with the other clients
+         * @param p the param that changed
+         * @param whole the update with the param's whole value, if it's been
+         * made. It's made here if this client needs it, and then shared too.
+         */
+        void push(const Update& update, const IParam* p, Update& whole);
+
      private:
         CatenaServiceImpl *service_;
         ServerContext context_;
         catena::ConnectPayload req_;
         catena::PushUpdates res_;
+        Update sending_;  ///< the update being written, kept until the write is done
+        std::deque<Update> updates_;
+        /**
+         * @brief the queued update of each param, keyed by slot and oid, so
+         * that a param changed again before it's sent isn't queued twice
+         */
+        std::map<std::pair<uint32_t, std::string>, Update*> queued_;
         ServerAsyncWriter<catena::PushUpdates> writer_;
         CallStatus status_;
-        Device &dm_;
         std::mutex mtx_;
         std::condition_variable cv_;
         bool hasUpdate_{false};
         int objectId_;
         static int objectCounter_;
-        unsigned int pushUpdatesId_;
-        unsigned int valueSetByClientId_;
-        unsigned int valueSetByServerId_;
         static vdk::signal<void()> shutdownSignal_;
         unsigned int shutdownSignalId_;
     };
@@ -164,7 +232,7 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
      */
     class DeviceRequest : public CallData {
       public:
-        DeviceRequest(CatenaServiceImpl *service, Device &dm, bool ok);
+        DeviceRequest(CatenaServiceImpl *service, bool ok);
 
         void proceed(CatenaServiceImpl *service, bool ok) override;
 
@@ -175,7 +243,6 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
         catena::DeviceRequestPayload req_;
         ServerAsyncWriter<catena::DeviceComponent> writer_;
         CallStatus status_;
-        Device &dm_;
         int objectId_;
         static int objectCounter_;
         unsigned int shutdownSignalId_;
@@ -183,7 +250,7 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
 
     class ExternalObjectRequest : public CallData {
       public:
-        ExternalObjectRequest(CatenaServiceImpl *service, Device &dm, bool ok);
+        ExternalObjectRequest(CatenaServiceImpl *service, bool ok);
         ~ExternalObjectRequest() {}
 
         void proceed(CatenaServiceImpl *service, bool ok) override;
@@ -194,7 +261,6 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
         catena::ExternalObjectRequestPayload req_;
         ServerAsyncWriter<catena::ExternalObjectPayload> writer_;
         CallStatus status_;
-        Device &dm_;
         int objectId_;
         static int objectCounter_;
     };
@@ -204,7 +270,7 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
     //  */
     // class GetParam : public CallData {
     //   public:
-    //     GetParam(CatenaServiceImpl *service, Device &dm, bool ok);
+    //     GetParam(CatenaServiceImpl *service, bool ok);
     //     ~GetParam() {}
 
     //     void proceed(CatenaServiceImpl *service, bool ok) override;
@@ -223,5 +289,39 @@ class CatenaServiceImpl final : public catena::CatenaService::AsyncService {
     //     static int objectCounter_;
     // };
 
+  private:
+    /**
+     * @brief serialize an update to a param
+     * @param slot the slot of the device whose value changed
+     * @param oid the oid of the param that changed
+     * @param p the param that changed
+     * @param idx the element index, or -1 for the whole value
+     */
+    static Update makeUpdate_(uint32_t slot, const std::string& oid, const IParam* p, int32_t idx);
+
+    /**
+     * @brief queue an update from one of the hosted devices on every open
+     * Connect stream. It's serialized once, however many streams there are.
+     * @param slot the slot of the device whose value changed
+     * @param oid the oid of the param that changed
+     * @param p the param that changed
+     * @param idx the element index, or -1 for the whole value
+     */
+    void push_(uint32_t slot, const std::string& oid, const IParam* p, int32_t idx);
 
+    /**
+     * @brief the signal connections made to one hosted device
+     */
+    struct Listener {
+        Device* dm;
+        unsigned int valueSetByClientId;
+        unsigned int valueSetByServerId;
+    };
+    std::vector<Listener> listeners_;
+
+    /**
+     * @brief the open Connect streams that updates are pushed to
+     */
+    std::vector<Connect*> connects_;
+    std::mutex connectsMutex_;
 };
\ No newline at end of file
@@ -3,7 +3,9 @@
 
 #include <connections/gRPC/include/ServiceImpl.h>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <thread>
 #include <fstream>
 #include <vector>
@@ -44,18 +46,57 @@ std::string timeNow() {
 
 
 CatenaServiceImpl::CatenaServiceImpl(ServerCompletionQueue *cq, Device &dm, std::string& EOPath)
-        : catena::CatenaService::AsyncService{}, cq_{cq}, dm_{dm}, EOPath_{EOPath} {}
+        : CatenaServiceImpl(cq, Devices{dm}, EOPath) {}
+
+CatenaServiceImpl::CatenaServiceImpl(ServerCompletionQueue *cq, const Devices& dms, std::string& EOPath)
+        : catena::CatenaService::AsyncService{}, cq_{cq}, dms_{}, EOPath_{EOPath} {
+    if (dms.empty()) {
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\nat least one device must be hosted";
+        throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
+    }
+    for (Device& dm : dms) {
+        if (!dms_.emplace(dm.slot(), &dm).second) {
+            std::stringstream why;
+            why << __PRETTY_FUNCTION__ << "\nslot " << dm.slot() << " is occupied by more than one device";
+            throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
+        }
+    }
+    for (const auto& [slot, dm] : dms_) {
+        auto push = [this, slot](const std::string& oid, const IParam* p, const int32_t idx) {
+            push_(slot, oid, p, idx);
+        };
+        listeners_.push_back({dm, dm->valueSetByClient.connect(push), dm->valueSetByServer.connect(push)});
+    }
+}
+
+CatenaServiceImpl::~CatenaServiceImpl() {
+    for (const Listener& l : listeners_) {
+        l.dm->valueSetByClient.disconnect(l.valueSetByClientId);
+        l.dm->valueSetByServer.disconnect(l.valueSetByServerId);
+    }
+}
 
 void CatenaServiceImpl::init() {
-    new GetPopulatedSlots(this, dm_, true);
-    new GetValue(this, dm_, true);
-    new SetValue(this, dm_, true);
-    new Connect(this, dm_, true);
-    new DeviceRequest(this, dm_, true);
-    new ExternalObjectRequest(this, dm_, true);
+    new GetPopulatedSlots(this, true);
+    new GetValue(this, true);
+    new SetValue(this, true);
+    new Connect(this, true);
+    new DeviceRequest(this, true);
+    new ExternalObjectRequest(this, true);
     // new GetParam(this, dm_, true);
 }
 
+Device& CatenaServiceImpl::dm(uint32_t slot) const {
+    auto it = dms_.find(slot);
+    if (it == dms_.end()) {
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\nno device in slot " << slot;
+        throw catena::exception_with_status(why.str(), catena::StatusCode::NOT_FOUND);
+    }
+    return *it->second;
+}
+
 int CatenaServiceImpl::GetPopulatedSlots::objectCounter_ = 0;
 int CatenaServiceImpl::GetValue::objectCounter_ = 0; 
 int CatenaServiceImpl::SetValue::objectCounter_ = 0;
@@ -139,7 +180,7 @@ void CatenaServiceImpl::deregisterItem(CallData *cd) {
 //     return scopes;
 // }
 
-CatenaServiceImpl::GetPopulatedSlots::GetPopulatedSlots(CatenaServiceImpl *service, Device &dm, bool ok): service_{service}, dm_{dm}, responder_(&context_),
+CatenaServiceImpl::GetPopulatedSlots::GetPopulatedSlots(CatenaServiceImpl *service, bool ok): service_{service}, responder_(&context_),
               status_{ok ? CallStatus::kCreate : CallStatus::kFinish} {
     objectId_ = objectCounter_++;
     service->registerItem(this);
@@ -163,10 +204,12 @@ void CatenaServiceImpl::GetPopulatedSlots::proceed(CatenaServiceImpl *service, b
 
         case CallStatus::kProcess:
             {
-                new GetPopulatedSlots(service_, dm_, ok);
+                new GetPopulatedSlots(service_, ok);
                 context_.AsyncNotifyWhenDone(this);
                 catena::SlotList ans;
-                ans.add_slots(dm_.slot());
+                for (const auto& [slot, dm] : service_->slots()) {
+                    ans.add_slots(slot);
+                }
                 status_ = CallStatus::kFinish;
                 responder_.Finish(ans, Status::OK, this);
             }
@@ -189,7 +232,7 @@ void CatenaServiceImpl::GetPopulatedSlots::proceed(CatenaServiceImpl *service, b
     }
 }
 
-CatenaServiceImpl::GetValue::GetValue(CatenaServiceImpl *service, Device &dm, bool ok): service_{service}, dm_{dm}, responder_(&context_),
+CatenaServiceImpl::GetValue::GetValue(CatenaServiceImpl *service, bool ok): service_{service}, responder_(&context_),
               status_{ok ? CallStatus::kCreate : CallStatus::kFinish} {
     objectId_ = objectCounter_++;
     service->registerItem(this);
@@ -212,19 +255,20 @@ void CatenaServiceImpl::GetValue::proceed(CatenaServiceImpl *service, bool ok) {
             break;
 
         case CallStatus::kProcess:
-            new GetValue(service_, dm_, ok);
+            new GetValue(service_, ok);
             context_.AsyncNotifyWhenDone(this);
             try {
                 // std::vector<std::string> clientScopes = getScopes(context_);
                 catena::Value ans;
-                catena::lite::IParam* param = dm_.getItem(req_.oid(), Device::ParamTag{});
+                Device& dm = service_->dm(req_.slot());
+                catena::lite::IParam* param = dm.getItem(req_.oid(), Device::ParamTag{});
                     if (param == nullptr) {
                     std::stringstream why;
                     why << __PRETTY_FUNCTION__ << "\nparam '" << req_.oid() << "' not found";
                     throw catena::exception_with_status(why.str(), catena::StatusCode::NOT_FOUND);
                 }
                 {
-                    Device::LockGuard lg(dm_);
+                    Device::LockGuard lg(dm);
                     param->toProto(ans);
                 }
                 status_ = CallStatus::kFinish;
@@ -255,8 +299,8 @@ void CatenaServiceImpl::GetValue::proceed(CatenaServiceImpl *service, bool ok) {
     }
 }
 
-CatenaServiceImpl::SetValue::SetValue(CatenaServiceImpl *service, Device &dm, bool ok)
-    : service_{service}, dm_{dm}, responder_(&context_),
+CatenaServiceImpl::SetValue::SetValue(CatenaServiceImpl *service, bool ok)
+    : service_{service}, responder_(&context_),
         status_{ok ? CallStatus::kCreate : CallStatus::kFinish} {
     objectId_ = objectCounter_++;
     service->registerItem(this);
@@ -279,11 +323,12 @@ void CatenaServiceImpl::SetValue::proceed(CatenaServiceImpl *service, bool ok) {
             break;
 
         case CallStatus::kProcess:
-            new SetValue(service_, dm_, ok);
+            new SetValue(service_, ok);
             context_.AsyncNotifyWhenDone(this);
             try {
                 //std::vector<std::string> clientScopes = getScopes(context_);
-                auto dstParam = dm_.getItem(req_.oid(), Device::ParamTag{});
+                Device& dm = service_->dm(req_.slot());
+                auto dstParam = dm.getItem(req_.oid(), Device::ParamTag{});
                 if (dstParam == nullptr) {
                     std::stringstream why;
                     why << __PRETTY_FUNCTION__ << "\nparam '" << req_.oid() << "' not found";
@@ -295,9 +340,11 @@ void CatenaServiceImpl::SetValue::proceed(CatenaServiceImpl *service, bool ok) {
                     throw catena::exception_with_status(why.str(), catena::StatusCode::PERMISSION_DENIED);
                 }
                 {
-                    Device::LockGuard lg(dm_);
-                    dstParam->fromProto(*req_.mutable_value());
-                    dm_.valueSetByClient.emit(req_.oid(), dstParam, req_.element_index());
+                    Device::LockGuard lg(dm);
+                    // element values of array params are written in place, or
+                    // appended if element_index is kEnd. Only what was written is pushed.
+                    uint32_t idx = dstParam->fromProto(*req_.mutable_value(), req_.element_index());
+                    dm.notifyValueSetByClient(dstParam->getOid(), dstParam, static_cast<int32_t>(idx));
                 }
                 status_ = CallStatus::kFinish;
                 responder_.Finish(::google::protobuf::Empty{}, Status::OK, this);
@@ -329,8 +376,8 @@ void CatenaServiceImpl::SetValue::proceed(CatenaServiceImpl *service, bool ok) {
     }
 }
 
-CatenaServiceImpl::Connect::Connect(CatenaServiceImpl *service, Device &dm, bool ok)
-    : service_{service}, dm_{dm}, writer_(&context_),
+CatenaServiceImpl::Connect::Connect(CatenaServiceImpl *service, bool ok)
+    : service_{service}, writer_(&context_),
         status_{ok ? CallStatus::kCreate : CallStatus::kFinish} {
     service->registerItem(this);
     objectId_ = objectCounter_++;
@@ -359,50 +406,30 @@ void CatenaServiceImpl::Connect::proceed(CatenaServiceImpl *service, bool ok) {
             break;
 
         case CallStatus::kProcess:
-            new Connect(service_, dm_, ok);  // to serve other clients
+            new Connect(service_, ok);  // to serve other clients
             context_.AsyncNotifyWhenDone(this);
             shutdownSignalId_ = shutdownSignal_.connect([this](){
                 context_.TryCancel();
-                hasUpdate_ = true;
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    hasUpdate_ = true;
+                }
                 this->cv_.notify_one();
             });
-            valueSetByServerId_ = dm_.valueSetByServer.connect([this](const std::string& oid, const IParam* p, const int32_t idx){
-                try{
-                    if (!this->context_.IsCancelled()){
-                        //std::vector<std::string> scopes = getScopes(this->context_);
-                        this->res_.mutable_value()->set_oid(oid);
-                        this->res_.mutable_value()->set_element_index(idx);
-                        p->toProto(*this->res_.mutable_value()->mutable_value());
-                    }
-                    this->hasUpdate_ = true;
-                    this->cv_.notify_one();
-                }catch(catena::exception_with_status& why){
-                    // Error is thrown for connected clients without authorization
-                    // Don't need to send any updates to unauthorized clients
-                } 
-            });
-            valueSetByClientId_ = dm_.valueSetByClient.connect([this](const std::string& oid, const IParam* p, const int32_t idx){
-                try{
-                    if (!this->context_.IsCancelled()){
-                        //std::vector<std::string> scopes = getScopes(this->context_);
-                        this->res_.mutable_value()->set_oid(oid);
-                        this->res_.mutable_value()->set_element_index(idx);
-                        p->toProto(*this->res_.mutable_value()->mutable_value());
-                    }
-                    this->hasUpdate_ = true;
-                    this->cv_.notify_one();
-                }catch(catena::exception_with_status& why){
-                    // Error is thrown for connected clients without authorization
-                    // Don't need to send any updates to unauthorized clients
-                } 
-            });
+            {
+                std::lock_guard<std::mutex> lock(service_->connectsMutex_);
+                service_->connects_.push_back(this);
+            }
 
-            // send client a empty update with slot of the device
+            // send client an update listing the slots it will receive updates from
             {
                 status_ = CallStatus::kWrite;
-                catena::PushUpdates populatedSlots;
-                populatedSlots.set_slot(dm_.slot());
-                writer_.Write(populatedSlots, this);
+                res_.Clear();
+                res_.set_slot(service_->slots().begin()->first);
+                for (const auto& [slot, dm] : service_->slots()) {
+                    res_.mutable_slots_added()->add_slots(slot);
+                }
+                writer_.Write(res_, this);
             }
             break;
 
@@ -411,16 +438,21 @@ void CatenaServiceImpl::Connect::proceed(CatenaServiceImpl *service, bool ok) {
             std::cout << "waiting on cv : " << timeNow() << std::endl;
             cv_.wait(lock, [this] { return hasUpdate_; });
             std::cout << "cv wait over : " << timeNow() << std::endl;
-            hasUpdate_ = false;
-            if (context_.IsCancelled()) {
+            // woken with nothing queued only when the call is being shut down,
+            // which IsCancelled may not report until the cancellation completes
+            if (updates_.empty() || context_.IsCancelled()) {
                 status_ = CallStatus::kFinish;
                 std::cout << "Connection[" << objectId_ << "] cancelled\n";
                 writer_.Finish(Status::CANCELLED, this);
                 break;
             } else {
                 std::cout << "sending update\n";
-                res_.set_slot(dm_.slot());
-                writer_.Write(res_, this);
+                // the update must outlive the write, so it's moved out of the queue
+                sending_ = std::move(updates_.front());
+                updates_.pop_front();
+                queued_.erase({sending_->slot(), sending_->value().oid()});
+                hasUpdate_ = !updates_.empty();
+                writer_.Write(*sending_, this);
             }
             lock.unlock();
             break;
@@ -433,15 +465,68 @@ void CatenaServiceImpl::Connect::proceed(CatenaServiceImpl *service, bool ok) {
         case CallStatus::kFinish:
             std::cout << "Connect[" << objectId_ << "] finished\n";
             shutdownSignal_.disconnect(shutdownSignalId_);
-            dm_.valueSetByClient.disconnect(valueSetByClientId_);
-            dm_.valueSetByServer.disconnect(valueSetByServerId_);
+            {
+                std::lock_guard<std::mutex> lock(service->connectsMutex_);
+                auto& connects = service->connects_;
+                connects.erase(std::remove(connects.begin(), connects.end(), this), connects.end());
+            }
             service->deregisterItem(this);
             break;
     }
 }
 
-CatenaServiceImpl::DeviceRequest::DeviceRequest(CatenaServiceImpl *service, Device &dm, bool ok)
-    : service_{service}, dm_{dm}, writer_(&context_),
+CatenaServiceImpl::Update CatenaServiceImpl::makeUpdate_(uint32_t slot, const std::string& oid, const IParam* p, const int32_t idx) {
+    auto update = std::make_shared<catena::PushUpdates>();
+    update->set_slot(slot);
+    update->mutable_value()->set_oid(oid);
+    update->mutable_value()->set_element_index(idx);
+    p->toProto(*update->mutable_value()->mutable_value(), static_cast<uint32_t>(idx));
+    return update;
+}
+
+void CatenaServiceImpl::push_(uint32_t slot, const std::string& oid, const IParam* p, const int32_t idx) {
+    std::lock_guard<std::mutex> lock(connectsMutex_);
+    if (connects_.empty()) {
+        return;
+    }
+    try {
+        //std::vector<std::string> scopes = getScopes(context_);
+        // every client is sent the same update, so it's serialized once, which
+        // for BINARY and DATA params is the only copy made of their payload
+        Update update = makeUpdate_(slot, oid, p, idx);
+        Update whole = idx < 0 ? update : nullptr;
+        for (Connect* connect : connects_) {
+            connect->push(update, p, whole);
+        }
+    } catch (catena::exception_with_status& why) {
+        // Error is thrown for connected clients without authorization
+        // Don't need to send any updates to unauthorized clients
+    }
+}
+
+void CatenaServiceImpl::Connect::push(const Update& update, const IParam* p, Update& whole) {
+    if (!context_.IsCancelled()) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        // a param already waiting to be sent is replaced where it is by its
+        // whole value, so a slow client's queue holds at most one update per
+        // param
+        auto [it, added] = queued_.try_emplace({update->slot(), update->value().oid()}, nullptr);
+        if (added) {
+            updates_.push_back(update);
+            it->second = &updates_.back();
+        } else {
+            if (!whole) {
+                whole = makeUpdate_(update->slot(), update->value().oid(), p, -1);
+            }
+            *it->second = whole;
+        }
+        hasUpdate_ = true;
+    }
+    cv_.notify_one();
+}
+
+CatenaServiceImpl::DeviceRequest::DeviceRequest(CatenaServiceImpl *service, bool ok)
+    : service_{service}, writer_(&context_),
         status_{ok ? CallStatus::kCreate : CallStatus::kFinish} {
     service->registerItem(this);
     objectId_ = objectCounter_++;
@@ -466,7 +551,7 @@ void CatenaServiceImpl::DeviceRequest::proceed(CatenaServiceImpl *service, bool
             break;
 
         case CallStatus::kProcess:
-            new DeviceRequest(service_, dm_, ok);  // to serve other clients
+            new DeviceRequest(service_, ok);  // to serve other clients
             context_.AsyncNotifyWhenDone(this);
             //clientScopes_ = getScopes(context_);
             // deviceStream_.attachClientScopes(clientScopes_);
@@ -478,15 +563,19 @@ void CatenaServiceImpl::DeviceRequest::proceed(CatenaServiceImpl *service, bool
             // fall thru to start writing
 
         case CallStatus::kWrite:
-            {
+            try {
                 catena::DeviceComponent deviceMessage{};
                 catena::Device* dstDevice = deviceMessage.mutable_device();
+                Device& dm = service_->dm(req_.slot());
                 {
-                    Device::LockGuard lg(dm_);
-                    dm_.toProto(*dstDevice, false); // select the deep copy option
+                    Device::LockGuard lg(dm);
+                    dm.toProto(*dstDevice, false); // select the deep copy option
                 }
                 status_ = CallStatus::kPostWrite;
                 writer_.Write(deviceMessage, this);
+            } catch (catena::exception_with_status &e) {
+                status_ = CallStatus::kFinish;
+                writer_.Finish(Status(static_cast<grpc::StatusCode>(e.status), e.what()), this);
             }
             break;
 
@@ -503,8 +592,8 @@ void CatenaServiceImpl::DeviceRequest::proceed(CatenaServiceImpl *service, bool
     }
 }
 
-CatenaServiceImpl::ExternalObjectRequest::ExternalObjectRequest(CatenaServiceImpl *service, Device &dm, bool ok)
-    : service_{service}, dm_{dm}, writer_(&context_),
+CatenaServiceImpl::ExternalObjectRequest::ExternalObjectRequest(CatenaServiceImpl *service, bool ok)
+    : service_{service}, writer_(&context_),
     status_{ok ? CallStatus::kCreate : CallStatus::kFinish} {
     service->registerItem(this);
     objectId_ = objectCounter_++;
@@ -529,7 +618,7 @@ void CatenaServiceImpl::ExternalObjectRequest::proceed(CatenaServiceImpl *servic
             break;
 
         case CallStatus::kProcess:
-            new ExternalObjectRequest(service_, dm_, ok);  // to serve other clients
+            new ExternalObjectRequest(service_, ok);  // to serve other clients
             context_.AsyncNotifyWhenDone(this);
             status_ = CallStatus::kWrite;
             // fall thru to start writing
@@ -590,7 +679,7 @@ void CatenaServiceImpl::ExternalObjectRequest::proceed(CatenaServiceImpl *servic
     // class GetParam : public CallData {
     //   public:
     //     GetParam(CatenaServiceImpl *service, Device &dm, bool ok)
-    //         : service_{service}, dm_{dm}, writer_(&context_),
+    //         : service_{service}, writer_(&context_),
     //           status_{ok ? CallStatus::kCreate : CallStatus::kFinish} {
     //         service->registerItem(this);
     //         objectId_ = objectCounter_++;
@@ -29,15 +29,20 @@
 #include <Path.h>
 #include <Status.h>
 #include <Fake.h>
+#include <ModelCache.h>
 
+#include <atomic>
 #include <mutex>
 #include <memory>
+#include <shared_mutex>
 #include <iostream>
 #include <string>
 #include <type_traits>
 #include <functional>
 #include <fstream>
 #include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
 
 
 namespace catena {
@@ -68,8 +73,11 @@ class DeviceModel {
     /**
      * @brief Mutex type
      *
+     * Reads of the model share it so that they run concurrently, changes to
+     * the model, including building accessors that may fill in a param's
+     * templated data, hold it exclusively.
      */
-    using Mutex = std::mutex;
+    using Mutex = std::shared_mutex;
 
     /**
      * @brief Payload for ParamAccessor
@@ -130,13 +138,29 @@ class DeviceModel {
     /**
      * @brief Construct a new Device Model from a json file
      *
+     * If a cache is given, the model is loaded from it if neither the file
+     * nor any that it imports have changed since it was cached. Otherwise
+     * the model is read from the json files and cached, if it can be,
+     * for next time.
+     *
+     * The params' templates are applied as the model's loaded, rather than
+     * when each param is first accessed.
+     *
      * @param filename
+     * @param cache optional path of a compiled cache of the model, see
+     * ModelCache
      */
-    explicit DeviceModel(const std::string &filename);
+    explicit DeviceModel(const std::string &filename, const std::filesystem::path &cache = {});
 
     /**
      * @brief read access to the protobuf Device
      *
+     * No lock is taken, as one couldn't outlast the call. The device's
+     * constraints, menus, commands and language packs don't change once it's
+     * constructed; its params' values do, so read those through a
+     * ParamAccessor, or use the whole device only while no values are being
+     * set.
+     *
      * @return const catena::Device&
      */
     const catena::Device &device() const;
@@ -152,6 +176,14 @@ class DeviceModel {
     /**
      * @brief Get the Param object at path
      *
+     * Paths are resolved once and cached, so getting the same param again
+     * costs a single lookup. The cache is cleared by changes to the structure
+     * of the model, such as addParam.
+     *
+     * Paths can index into arrays, e.g. /channels/12/gain. A path that ends
+     * with an index gets an accessor to just that element, which is the only
+     * one it writes and pushes.
+     *
      * @param path uniquely locates the parameter
      * @throws catena::exception_with_status if the code to navigate
      * to the requested fully qualified oid has not been implemented.
@@ -169,7 +201,10 @@ class DeviceModel {
      * @param param the param to be added to the device model
      * @returns cached version of param which client can use
      * for ongoing access to the param in a threadsafe way
-     * @todo implement DeviceModel::addParam(const std::string &jptr, Param &&param)
+     * @throws catena::exception_with_status ALREADY_EXISTS if there's already
+     * a param at jptr
+     * @throws catena::exception_with_status UNIMPLEMENTED if jptr isn't a
+     * top-level oid
      */
     Param addParam(const std::string &jptr, Param &&param);
 
@@ -177,33 +212,150 @@ class DeviceModel {
     /**
      * @brief import sub-params from a folder
      *
+     * The files are read and parsed in parallel, a level of the tree at a
+     * time, and merged into the model in the same order as they'd be read
+     * one by one.
+     *
      * @param current_folder the folder to import from
      * @param params the params to import into
+     * @param sources [out] the files imported are added to this
      */
-    void importSubParams_(std::filesystem::path &current_folder, ParamsMap &params);
+    void importSubParams_(std::filesystem::path &current_folder, ParamsMap &params,
+                          std::vector<ModelCache::Source> &sources);
 
     /**
      * @brief fill sub-params with template data
      *
+     * Only p is written, so params that aren't templates can be filled in
+     * parallel.
+     *
      * @param p [in-out] parent whose children are to be walked
-     * @param p_oid [in] oid of parent param
      * */
-    void checkSubParamTemplates_(catena::Param &p, const std::string &p_oid);
+    void checkSubParamTemplates_(catena::Param &p) const;
 
     /**
      * @brief get template data from the device model
      *
+     * Only p is written, so params that aren't templates can be filled in
+     * parallel.
+     *
      * @param p [in-out] param to be copied into
-     * @param path [in] template_oid to look up
+     * @param path [in] template_oid to look up, which can index into
+     * arrays to use one of their elements as the template
+     */
+    void checkTemplateData_(catena::Param &p, const std::string &path) const;
+
+    /**
+     * @brief apply the templates of every top-level param, once the model's
+     * been read
+     *
+     * The inline constraints of templates are first moved into the device's
+     * shared constraints, so the params made from them refer to a single
+     * copy. Then the params are filled in parallel: those that are templates
+     * themselves into copies that replace them once all are filled, so the
+     * templates are only read while they're in use. A param whose templates
+     * can't be applied is left to report why when it's accessed.
+     */
+    void resolveTemplates_();
+
+    /**
+     * @brief move the inline constraint of each template into the device's
+     * shared constraints, replacing it with a reference
+     *
+     * @param templateOids [in] the template_oids used by the model's params
+     */
+    void shareTemplateConstraints_(const std::unordered_set<std::string> &templateOids);
+
+    /**
+     * @brief apply the templates of a top-level param and its sub-params,
+     * the first time it's accessed
+     *
+     * @param p [in-out] the param
+     * @param oid [in] its oid
+     * @note call with mutex_ held
+     */
+    void templateOnce_(catena::Param &p, const std::string &oid);
+
+    /**
+     * @brief the top-level params in the order they're streamed, with their
+     * access scopes numbered so that a client's access to each can be worked
+     * out once per stream rather than once per param
      */
-    void checkTemplateData_(catena::Param &p, const std::string &path);
+    struct StreamIndex {
+        struct Entry {
+            std::string oid;      /**< e.g. "/a_number" */
+            uint32_t scope;       /**< index into scopes */
+            catena::Param *param; /**< the param's descriptor */
+            catena::Value *value; /**< the param's value */
+        };
+        std::vector<std::string> scopes; /**< each distinct access scope */
+        std::vector<Entry> params;       /**< every top-level param */
+    };
+
+    /**
+     * @brief get the stream index, building it if the model has changed
+     * structure since it was last built
+     *
+     * The index is shared with the streams using it, so they can finish
+     * with the one they started with.
+     */
+    std::shared_ptr<const StreamIndex> streamIndex_();
+
+    /**
+     * @brief what a path resolves to
+     *
+     * The descriptor and scope of a param only change with the structure of
+     * the model. The values of top-level params live as long as their
+     * descriptors do, but those of sub-params belong to their parent's value
+     * and are destroyed if it's replaced as a whole, so they're only valid
+     * while the epoch they were resolved in is current.
+     */
+    struct ResolvedParam {
+        catena::Param *param;
+        catena::Value *value;
+        std::string scope;
+        ParamIndex index;
+        bool nested;
+        uint64_t epoch;
+    };
+
+    /**
+     * @brief resolve path to the data needed to create its ParamAccessor
+     *
+     * @param path [in-out] the parsed path, consumed as it's walked
+     * @return the param, its value and its scope
+     * @note call with mutex_ held
+     */
+    ResolvedParam resolve_(catena::common::Path &path);
+
+    /**
+     * @brief tell the path cache that the sub-values of a struct or variant
+     * value have been replaced, so the cached values of sub-params may no
+     * longer exist
+     *
+     * @note call with mutex_ held
+     */
+    inline void subValuesReplaced_() { ++valueEpoch_; }
+
+    /**
+     * @brief forget every resolved path, after a change to the structure of
+     * the model
+     *
+     * @note call with mutex_ held
+     */
+    void clearPathCache_();
 
   private:
     catena::Device device_;                    /**< the protobuf device model */
-    mutable Mutex mutex_;                      /**< used to mediate access */
+    mutable Mutex mutex_;                      /**< shared by readers, exclusive to writers */
     static catena::Value noValue_;             /**< to flag undefined values */
     std::unordered_set<std::string> accessed_; /**< params that have been built at least once */
 
+    std::unordered_map<std::string, ResolvedParam> pathCache_; /**< resolved paths, by jptr */
+    mutable std::shared_mutex pathCacheMutex_;                 /**< taken after mutex_, if both are */
+    std::atomic<uint64_t> valueEpoch_{0};                     /**< bumped when sub-values are replaced */
+    std::shared_ptr<const StreamIndex> builtStreamIndex_;     /**< built on demand, guarded by mutex_ */
+
   public:
     /**
      *  signal to share value changes by clients
@@ -263,7 +415,6 @@ class DeviceStream {
     const catena::DeviceComponent &next();
 
   private:
-    using ParamIterator = google::protobuf::Map<std::string, catena::Param>::const_iterator;
     using ConstraintIterator = google::protobuf::Map<std::string, catena::Constraint>::const_iterator;
     using MenuGroupIterator = google::protobuf::Map<std::string, catena::MenuGroup>::const_iterator;
     using MenuIterator = google::protobuf::Map<std::string, catena::Menu>::const_iterator;
@@ -322,7 +473,9 @@ class DeviceStream {
         kFinished
     };
 
-    ParamIterator paramIter_;
+    std::shared_ptr<const DeviceModel::StreamIndex> params_; /**< the params to stream */
+    std::size_t paramPos_ = 0;                               /**< the next param to stream */
+    std::vector<bool> scopeAllowed_;                         /**< by params_->scopes index */
     ConstraintIterator constraintIter_;
     MenuGroupIterator menuGroupIter_;
     MenuIterator menuIter_;
@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @brief Compiled cache of a device model read from json files.
+ * @file ModelCache.h
+ * @copyright Copyright © 2024 Ross Video Ltd
+ */
+
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <full/device.pb.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace catena {
+namespace full {
+
+/**
+ * @brief Keeps a device model that was read from json files as a serialized
+ * catena::Device, so that it can be loaded without parsing the json again.
+ *
+ * The cache is two files: the serialized device at the cache's path, and a
+ * manifest next to it, with a ".manifest" extension added, of the json files
+ * it was read from. The manifest records each file's size, modification time
+ * and hash. The cache is valid while they all match; a file whose size or
+ * modification time has changed is hashed to check whether its content has.
+ * The manifest also records a hash of the catena::Device schema, so a cache
+ * written by a build with a different schema isn't valid either, and the size
+ * and hash of the serialized device, so a damaged one isn't loaded.
+ */
+class ModelCache {
+  public:
+    /**
+     * @brief what the manifest records about a source file
+     */
+    struct Source {
+        std::filesystem::path path; /**< absolute */
+        uintmax_t size;
+        int64_t mtime;              /**< when the file was read, or earlier */
+        uint64_t hash;              /**< of the content that was read */
+    };
+
+    /**
+     * @brief read a source file of a model, describing it for the manifest
+     *
+     * The file's modification time is taken before it's read, and its hash
+     * from the content read, so that a file changed while it's being read
+     * makes the cache stale rather than wrong.
+     *
+     * @param path [in] the file
+     * @param src [out] its description
+     * @return its content
+     */
+    static std::string readSource(const std::filesystem::path& path, Source& src);
+
+    /**
+     * @brief Construct a cache
+     * @param path where the serialized device is, or is to be, kept
+     */
+    explicit ModelCache(const std::filesystem::path& path);
+
+    /**
+     * @brief load the cached device, if the cache is valid
+     *
+     * @param source [in] the top-level file the device is read from, to check
+     * that the cache is of the same model
+     * @param dst [out] the device, if the cache is valid
+     * @return true if the cache was valid and the device was loaded
+     */
+    bool load(const std::filesystem::path& source, catena::Device& dst) const;
+
+    /**
+     * @brief cache a device
+     *
+     * The manifest is written last, so a cache that isn't completely written
+     * isn't valid.
+     *
+     * @param device the device to cache
+     * @param sources the files it was read from, the first being the
+     * top-level one, as described by readSource
+     * @throws catena::exception_with_status INTERNAL if the cache can't be
+     * written, or the serialized device is 2 GiB or more
+     */
+    void save(const catena::Device& device, const std::vector<Source>& sources) const;
+
+    /**
+     * @brief the path of the manifest
+     */
+    inline const std::filesystem::path& manifest() const { return manifest_; }
+
+  private:
+    /**
+     * @brief read the manifest
+     * @param sources [out] the source files it lists
+     * @param deviceSize [out] the size of the serialized device
+     * @param deviceHash [out] the hash of the serialized device
+     * @return false if there's no valid manifest
+     */
+    bool readManifest_(std::vector<Source>& sources, uintmax_t& deviceSize, uint64_t& deviceHash) const;
+
+    std::filesystem::path path_;     /**< the serialized device */
+    std::filesystem::path manifest_; /**< the manifest of its sources */
+};
+
+}  // namespace full
+}  // namespace catena
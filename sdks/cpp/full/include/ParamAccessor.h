@@ -36,11 +36,14 @@
 
 
 
+#include <array>
+#include <cstddef>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include <type_traits>
 #include <typeinfo>
 #include <typeindex>
@@ -61,6 +64,13 @@ template <typename T> struct PassByValueOrReference {
  */
 template <typename V> catena::Value::KindCase getKindCase(const V& src);
 
+/**
+ * @brief true if V is an element type the indexed getValue / setValue support
+ */
+template <typename V>
+inline constexpr bool is_array_element =
+  std::is_same_v<V, int32_t> || std::is_same_v<V, float> || std::is_same_v<V, std::string>;
+
 /**
  * @brief index value used to trigger special behaviors.
  *
@@ -86,7 +96,98 @@ inline static bool isList(const catena::Value& v) {
     return ans;
 }
 
+/**
+ * @brief the number of Value::KindCases, which are numbered from 0
+ */
+static constexpr std::size_t kKindCases = catena::Value::KindCase::kStructVariantArrayValues + 1;
+
+/**
+ * @brief A table of functions indexed by the Value::KindCase they work on.
+ *
+ * Its functions are plain function pointers added when the table is built,
+ * which is done in a constant expression, so looking one up takes no lock
+ * and does no hashing.
+ *
+ * @tparam R the return type of the functions
+ * @tparam Ms the functions' argument types
+ */
+template <typename R, typename... Ms> class KindDispatch {
+  public:
+    /**
+     * @brief type alias to the functions in the table
+     */
+    using Function = R (*)(Ms...);
+
+    constexpr KindDispatch() = default;
+
+    /**
+     * @brief add the function for a kind of value
+     * @param key the kind of value
+     * @param f the function
+     * @throws std::runtime_error if there's already a function for key, which
+     * is a compile time error when the table is built in a constant expression
+     */
+    constexpr void addFunction(const catena::Value::KindCase key, Function f) {
+        if (table_[key] != nullptr) {
+            throw std::runtime_error("KindDispatch::addFunction, attempted to register duplicate key");
+        }
+        table_[key] = f;
+    }
+
+    /**
+     * @brief the function for a kind of value
+     * @param key the kind of value
+     * @throws std::runtime_error if there's no function for key
+     */
+    Function operator[](const catena::Value::KindCase key) const {
+        const std::size_t i = static_cast<std::size_t>(key);
+        if (i >= kKindCases || table_[i] == nullptr) {
+            std::stringstream err;
+            err << __PRETTY_FUNCTION__ << ", key not found " << i;
+            throw std::runtime_error(err.str());
+        }
+        return table_[i];
+    }
+
+    /**
+     * @brief is there a function for a kind of value
+     * @param key the kind of value
+     */
+    constexpr bool has(const catena::Value::KindCase key) const {
+        const std::size_t i = static_cast<std::size_t>(key);
+        return i < kKindCases && table_[i] != nullptr;
+    }
+
+  private:
+    std::array<Function, kKindCases> table_{};
+};
+
+/**
+ * @brief the number of elements in v
+ *
+ * @param v a value of a list type
+ * @return the number of elements, or 0 if v isn't a list type
+ */
+inline static std::size_t arraySize(const catena::Value& v) {
+    switch (v.kind_case()) {
+        case catena::Value::KindCase::kInt32ArrayValues:
+            return v.int32_array_values().ints_size();
+        case catena::Value::KindCase::kFloat32ArrayValues:
+            return v.float32_array_values().floats_size();
+        case catena::Value::KindCase::kStringArrayValues:
+            return v.string_array_values().strings_size();
+        case catena::Value::KindCase::kStructArrayValues:
+            return v.struct_array_values().struct_values_size();
+        case catena::Value::KindCase::kStructVariantArrayValues:
+            return v.struct_variant_array_values().struct_variants_size();
+        default:
+            return 0;
+    }
+}
+
 class ParamAccessor {
+    friend DeviceStream; /**< so streams can copy params without building accessors to them */
+
   public:
     /**
      * @brief Mutexlock type
@@ -97,24 +198,22 @@ class ParamAccessor {
     /**
      * @brief type alias for the getter function for scalar types
      */
-    using Getter = catena::patterns::Functory<catena::Value::KindCase, void, void*, const catena::Value*>;
+    using Getter = KindDispatch<void, void*, const catena::Value*>;
 
     /**
-     * @brief type alias for the setter Functory for scalar types
+     * @brief type alias for the setter functions for scalar types
      */
-    using Setter = catena::patterns::Functory<catena::Value::KindCase, void, catena::Value*, const void*>;
+    using Setter = KindDispatch<void, catena::Value*, const void*>;
 
     /**
      * @brief type alias for the getter function for vector types
      */
-    using GetterAt = catena::patterns::Functory<catena::Value::KindCase, void, void*, const catena::Value*,
-                                                const ParamIndex>;
+    using GetterAt = KindDispatch<void, void*, const catena::Value*, const ParamIndex>;
 
     /**
-     * @brief type alias for the setter Functory for vector types
+     * @brief type alias for the setter functions for vector types
      */
-    using SetterAt = catena::patterns::Functory<catena::Value::KindCase, void, catena::Value*, const void*,
-                                                const ParamIndex>;
+    using SetterAt = KindDispatch<void, catena::Value*, const void*, const ParamIndex>;
 
     /**
      * @brief type alias for the function that gets the VariantInfo for a type
@@ -125,25 +224,23 @@ class ParamAccessor {
      * @brief type alias for the function that gets values from the device model for delivery to attached
      * clients
      */
-    using ValueGetter = catena::patterns::Functory<catena::Value::KindCase, void, Value*, const Value&>;
+    using ValueGetter = KindDispatch<void, Value*, const Value&>;
 
     /**
      * @brief type alias for the function that sets values in the device model in response to client requests
      */
-    using ValueSetter = catena::patterns::Functory<catena::Value::KindCase, void, Value&, const Value&>;
+    using ValueSetter = KindDispatch<void, Value&, const Value&>;
 
     /**
      * @brief type alias for the function that gets values from the device model for delivery to attached
      * clients
      */
-    using ValueGetterAt =
-      catena::patterns::Functory<catena::Value::KindCase, void, Value*, const Value&, ParamIndex>;
+    using ValueGetterAt = KindDispatch<void, Value*, const Value&, ParamIndex>;
 
     /**
      * @brief type alias for the function that sets values in the device model in response to client requests
      */
-    using ValueSetterAt =
-      catena::patterns::Functory<catena::Value::KindCase, void, Value&, const Value&, ParamIndex>;
+    using ValueSetterAt = KindDispatch<void, Value&, const Value&, ParamIndex>;
 
   public:
     /**
@@ -151,10 +248,12 @@ class ParamAccessor {
      *
      * @param dm the parent device model.
      * @param pad the data to initialize the param accessor
+     * @param index if not kParamEnd, the accessor is to this element of
+     * the array in pad, rather than to the whole array
      */
 
     ParamAccessor(DeviceModel& dm, DeviceModel::ParamAccessorData& pad, const std::string& oid,
-                  const std::string& scope);
+                  const std::string& scope, ParamIndex index = kParamEnd);
 
     /**
      * @brief ParamAccessor has no default constructor.
@@ -203,7 +302,7 @@ class ParamAccessor {
     // }
 
     template <bool Threadsafe = true> inline const Value& value() const {
-        using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<Mutex>, catena::common::FakeLock>;
+        using LockGuard = std::conditional_t<Threadsafe, std::shared_lock<Mutex>, catena::common::FakeLock>;
         LockGuard lock(deviceModel_.get().mutex_);
         return value_.get();
     }
@@ -267,11 +366,11 @@ class ParamAccessor {
      * param descriptor is not part of the active value of the larger object. If even present,
      * it's used as the default value for the matching part of the parent's value object.
      *
-     * This method is threadsafe because it asserts the DeviceModel's mutex.
+     * This method is threadsafe because it shares the DeviceModel's mutex with other readers.
      */
     template <bool Threadsafe>
     const std::unique_ptr<ParamAccessor> subParam(const std::string& fieldName) const {
-        using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<Mutex>, common::FakeLock>;
+        using LockGuard = std::conditional_t<Threadsafe, std::shared_lock<Mutex>, common::FakeLock>;
         LockGuard lock(deviceModel_.get().mutex_);
         Param& parent = param_.get();
         const Param& childParam = parent.params().at(fieldName);
@@ -311,23 +410,34 @@ class ParamAccessor {
      * implemented, or with catena::Status::UNKNOWN if an unknown exception is thrown is encountered.
      * Other catena::exception_with_status exceptions are re-thrown with no change to their status.
      *
+     * If the accessor is to an element of an array, dst is the element, and V must be
+     * int32_t, float or std::string; other types throw catena::Status::INVALID_ARGUMENT.
+     *
      * @tparam V type of the value stored by the param. This must be a native type.
      * @param dst reference to the destination object written to by this method.
      */
     template <bool Threadsafe = true, typename V> void getValue(V& dst) const {
+        if (index_ != kParamEnd) {
+            if constexpr (is_array_element<V>) {
+                getValue<Threadsafe>(dst, index_);
+                return;
+            } else {
+                BAD_STATUS("getValue of an array element only supports int32, float and string elements",
+                           catena::StatusCode::INVALID_ARGUMENT);
+            }
+        }
         try {
-            using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<Mutex>, catena::common::FakeLock>;
+            using LockGuard = std::conditional_t<Threadsafe, std::shared_lock<Mutex>, catena::common::FakeLock>;
             LockGuard lock(deviceModel_.get().mutex_);
-            auto& getter = Getter::getInstance();
             if constexpr (catena::full::has_getStructInfo<V>) {
                 // dst is a struct
                 const auto& structInfo = dst.getStructInfo();
                 char* base = reinterpret_cast<char*>(&dst);
-                auto* srcFields = value_.get().mutable_struct_value()->mutable_fields();
+                const auto& srcFields = value_.get().struct_value().fields();
                 for (auto& field : structInfo.fields) {
                     char* dstAddr = base + field.offset;
-                    const Value& srcField = srcFields->at(field.name).value();
-                    if (srcFields->contains(field.name)) {
+                    if (srcFields.contains(field.name)) {
+                        const Value& srcField = srcFields.at(field.name).value();
                         const catena::Value::KindCase kc = srcField.kind_case();
                         if (kc == Value::KindCase::kStructValue) {
                             // field is a struct
@@ -335,7 +445,7 @@ class ParamAccessor {
                             field.wrapGetter(dstAddr, sp.get());
                         } else {
                             // field is a simple or simple array type
-                            getter[kc](dstAddr, &srcField);
+                            getter_[kc](dstAddr, &srcField);
                         }
                     }
                 }
@@ -346,8 +456,7 @@ class ParamAccessor {
                 Value::KindCase kc = src.value().kind_case();
 
                 // gather info about the native destination
-                auto& variantInfoFunctory = catena::full::ParamAccessor::VariantInfoGetter::getInstance();
-                const catena::full::VariantInfo& variantInfo = variantInfoFunctory[std::type_index(typeid(V))]();
+                const catena::full::VariantInfo& variantInfo = variantInfo_<V>();
                 const catena::full::VariantMemberInfo vmi = variantInfo.members.at(variant);
 
                 // set the variant to the correct type, and return a pointer to it
@@ -361,11 +470,11 @@ class ParamAccessor {
                     BAD_STATUS("Variant of variant not supported", catena::StatusCode::INVALID_ARGUMENT);
                 } else {
                     // field is a simple or simple array type
-                    getter[kc](reinterpret_cast<char*>(ptr), &src.value());
+                    getter_[kc](reinterpret_cast<char*>(ptr), &src.value());
                 }
             } else {
                 // dst is a simple type or whole array
-                getter[getKindCase<V>(dst)](&dst, &value_.get());
+                getter_[getKindCase<V>(dst)](&dst, &value_.get());
             }
         } catch (const catena::exception_with_status& why) {
             std::stringstream err;
@@ -398,11 +507,10 @@ class ParamAccessor {
     template <bool Threadsafe = true, typename V> void getValue(V& dst, const ParamIndex idx) const {
         try {
             using ElementType = typename std::remove_reference<decltype(dst)>::type;
-            using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<Mutex>, catena::common::FakeLock>;
+            using LockGuard = std::conditional_t<Threadsafe, std::shared_lock<Mutex>, catena::common::FakeLock>;
             LockGuard lock(deviceModel_.get().mutex_);
-            auto& getter = GetterAt::getInstance();
             static std::vector<ElementType> x;
-            getter[getKindCase(x)](&dst, &value_.get(), idx);
+            getterAt_[getKindCase(x)](&dst, &value_.get(), idx);
         } catch (const catena::exception_with_status& why) {
             std::stringstream err;
             err << "getValueAt failed: " << why.what() << '\n' << __PRETTY_FUNCTION__ << '\n';
@@ -426,51 +534,37 @@ class ParamAccessor {
      * implemented, or with catena::Status::UNKNOWN if an unknown exception is thrown is encountered. Other
      * catena::exception_with_status exceptions are re-thrown with no change to their status.
      *
+     * If the accessor is to an element of an array, src replaces the element, and V must be
+     * int32_t, float or std::string; other types throw catena::Status::INVALID_ARGUMENT.
+     *
      * @tparam V type of the value stored by the param. This must be a native type.
      */
     template <bool Threadsafe = true, typename V> void setValue(const V& src) {
+        if (index_ != kParamEnd) {
+            if constexpr (is_array_element<V>) {
+                setValue<Threadsafe>(src, index_);
+                return;
+            } else {
+                BAD_STATUS("setValue of an array element only supports int32, float and string elements",
+                           catena::StatusCode::INVALID_ARGUMENT);
+            }
+        }
         try {
             using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<Mutex>, catena::common::FakeLock>;
             LockGuard lock(deviceModel_.get().mutex_);
-            auto& setter = Setter::getInstance();
-            if constexpr (catena::full::has_getStructInfo<V>) {
-                const auto& structInfo = src.getStructInfo();
-                const char* base = reinterpret_cast<const char*>(&src);
-                auto* dstFields = value_.get().mutable_struct_value()->mutable_fields();
-                for (auto& field : structInfo.fields) {
-                    const char* srcAddr = base + field.offset;
-                    if (!dstFields->contains(field.name)) {
-                        dstFields->insert({field.name, StructField{}});
-                        *dstFields->at(field.name).mutable_value() = Value{};
-                        std::unique_ptr<ParamAccessor> sp = subParam<false>(field.name);
-                        field.wrapSetter(sp.get(), srcAddr);
-                    } else {
-                        Value* dstField = dstFields->at(field.name).mutable_value();
-                        if (dstField->kind_case() == Value::KindCase::kStructValue) {
-                            // field is a struct
-                            std::unique_ptr<ParamAccessor> sp = subParam<false>(field.name);
-                            field.wrapSetter(sp.get(), srcAddr);
-                        } else {
-                            // field is a simple or simple array type
-                            setter[dstField->kind_case()](dstField, srcAddr);
-                        }
-                    }
-                }
-            } else if constexpr (catena::meta::is_variant<V>::value) {
-                auto& variantInfoFunctory = ParamAccessor::VariantInfoGetter::getInstance();
-                const catena::full::VariantInfo& variantInfo = variantInfoFunctory[std::type_index(typeid(V))]();
-                Value& v = value_.get();
-                StructVariantValue* vv = v.mutable_struct_variant_value();
-                std::string* currentVariant = vv->mutable_struct_variant_type();
-                const std::string& variant = variantInfo.lookup[src.index()];
-                const std::unique_ptr<ParamAccessor> sp = subParam<false>(variant);
-                if (variant.compare(*currentVariant) != 0) {
-                    // we need to change the variant type in the protobuf
-                    *currentVariant = variant;
-                }
-                variantInfo.members.at(variant).wrapSetter(sp.get(), &src);
+            if constexpr (catena::full::has_getStructInfo<V> || catena::meta::is_variant<V>::value) {
+                // written into a copy that replaces the value once every field
+                // has been converted, so a failure part way through leaves the
+                // value as it was
+                Value staged = value_.get();
+                DeviceModel::ParamAccessorData pad{&param_.get(), &staged};
+                ParamAccessor staging(deviceModel_.get(), pad, oid_, scope_, kParamEnd);
+                staging.setComposite_(src);
+                value_.get().Swap(&staged);
+                // the sub-values are now the copy's
+                deviceModel_.get().subValuesReplaced_();
             } else {
-                setter[getKindCase<V>(src)](&value_.get(), &src);
+                setter_[getKindCase<V>(src)](&value_.get(), &src);
             }
             deviceModel_.get().pushUpdates.emit(*this, kParamEnd);
         } catch (const catena::exception_with_status& why) {
@@ -507,10 +601,9 @@ class ParamAccessor {
             using ElementType = std::remove_const<typename std::remove_reference<decltype(src)>::type>::type;
             using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<Mutex>, catena::common::FakeLock>;
             LockGuard lock(deviceModel_.get().mutex_);
-            auto& setterAt = SetterAt::getInstance();
             static std::vector<ElementType> x;
-            setterAt[getKindCase(x)](&value_.get(), &src, idx);
-            deviceModel_.get().pushUpdates.emit(*this, idx);
+            setterAt_[getKindCase(x)](&value_.get(), &src, idx);
+            emitChange_(idx, [this](const ParamAccessor& p, ParamIndex i) { deviceModel_.get().pushUpdates.emit(p, i); });
         } catch (const catena::exception_with_status& why) {
             std::stringstream err;
             err << "setValue failed: " << why.what() << '\n' << __PRETTY_FUNCTION__ << '\n';
@@ -542,12 +635,15 @@ class ParamAccessor {
      * no lock is asserted - use when making recursive calls to avoid deadlock.
      */
     template <bool Threadsafe = true> void getValue(Value* dst) const {
-        using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<DeviceModel::Mutex>, catena::common::FakeLock>;
+        using LockGuard = std::conditional_t<Threadsafe, std::shared_lock<Mutex>, catena::common::FakeLock>;
         LockGuard lock(deviceModel_.get().mutex_);
-        auto& getter = ValueGetter::getInstance();
         try {
             const Value& value = value_.get();
-            getter[value.kind_case()](dst, value);
+            if (index_ != kParamEnd) {
+                valueGetterAt_[value.kind_case()](dst, value, index_);
+            } else {
+                valueGetter_[value.kind_case()](dst, value);
+            }
         } catch (const catena::exception_with_status& why) {
             std::stringstream err;
             err << "getValue failed: " << why.what() << '\n' << __PRETTY_FUNCTION__ << '\n';
@@ -564,7 +660,8 @@ class ParamAccessor {
      * sending to a client.
      *
      * @param dst [out] destination for the value
-     * @param idx [in] index into the array, if set to kParamEnd, the entire array is returned
+     * @param idx [in] index into the array, if set to kParamEnd, the entire array is returned.
+     * Ignored if the accessor is to an element of the array.
      * @param clientScopes [in] the scopes of the client requesting the value
      *
      * @throws catena::exception_with_status catena::Status::UNIMPLEMENTED if support for
@@ -577,7 +674,7 @@ class ParamAccessor {
      */
     template <bool Threadsafe = true>
     void getValue(Value* dst, ParamIndex idx, std::vector<std::string>& clientScopes) const {
-        using LockGuard = std::conditional_t<Threadsafe, std::lock_guard<DeviceModel::Mutex>, catena::common::FakeLock>;
+        using LockGuard = std::conditional_t<Threadsafe, std::shared_lock<Mutex>, catena::common::FakeLock>;
         LockGuard lock(deviceModel_.get().mutex_);
         try {
             if (clientScopes.size() == 0) {
@@ -591,14 +688,15 @@ class ParamAccessor {
                 }
             }
 
+            if (index_ != kParamEnd) {
+                idx = index_;
+            }
             const Value& value = value_.get();
             if (isList() && idx != kParamEnd) {
-                auto& getterAt = ValueGetterAt::getInstance();
-                getterAt[value.kind_case()](dst, value, idx);
+                valueGetterAt_[value.kind_case()](dst, value, idx);
             } else {
                 // value is a scalar or whole array type
-                auto& getter = ValueGetter::getInstance();
-                getter[value.kind_case()](dst, value);
+                valueGetter_[value.kind_case()](dst, value);
             }
         } catch (const catena::exception_with_status& why) {
             std::stringstream err;
@@ -622,6 +720,9 @@ class ParamAccessor {
      * the parameter type is not implemented, or with catena::Status::UNKNOWN if an unknown exception
      * is encountered, or with catena::Status::RANGE_ERROR if the index is out of range.
      *
+     * The constraint of an int32 or string parameter, its own or a shared one it
+     * refers to, is applied to src before it's written.
+     *
      * Threadsafe - asserts a lock on the DeviceModel's mutex.
      */
     void setValue(const std::string& peer, const Value& src);
@@ -631,13 +732,18 @@ class ParamAccessor {
      * received from client
      *
      * @param dst [out] destination for the value
-     * @param idx [in] index into the array, if set to kParamEnd, the entire array is returned
+     * @param idx [in] index into the array, if set to kParamEnd, the entire array is returned.
+     * Ignored if the accessor is to an element of the array, which is the only
+     * one written and pushed.
      * @param clientScopes [in] the scopes of the client requesting the value
      *
      * @throws catena::exception_with_status catena::Status::UNIMPLEMENTED if support for
      * the parameter type is not implemented, or with catena::Status::UNKNOWN if an unknown exception
      * is encountered, or with catena::Status::RANGE_ERROR if the index is out of range.
      *
+     * The constraint of an int32 or string parameter, its own or a shared one it
+     * refers to, is applied to src before it's written.
+     *
      * Threadsafe - asserts a lock on the DeviceModel's mutex.
      */
     void setValue(const std::string& peer, const Value& src, ParamIndex idx,
@@ -648,6 +754,8 @@ class ParamAccessor {
      * @param dst [out] a parameter component with unathorized fields removed
      * @param clientScopes [in] the scopes of the client requesting the parameter
      * @throws catena::exception_with_status catena::Status::PERMISSION_DENIED if the client is not authorized
+     *
+     * Threadsafe - shares the DeviceModel's mutex with other readers.
      */
     void getParam(catena::DeviceComponent_ComponentParam* dst, std::vector<std::string>& clientScopes) const;
 
@@ -668,13 +776,19 @@ class ParamAccessor {
      *
      * @todo add option to check scope for write access
      */
-    bool checkScope(const std::vector<std::string>& clientScopes, const std::string& paramScope) const;
+    static bool checkScope(const std::vector<std::string>& clientScopes, const std::string& paramScope);
 
     /**
      * @brief get the parameter's fully qualified object id
      */
     inline const std::string& oid() const { return oid_; }
 
+    /**
+     * @brief get the index of the array element the accessor is to, or
+     * kParamEnd if it's to the whole value
+     */
+    inline ParamIndex index() const { return index_; }
+
     /**
      * @brief get the parameter's unique id
      */
@@ -692,14 +806,88 @@ class ParamAccessor {
 
   private:
     /**
-     * @brief copies the param data skipping unauthorized fields
-     * @param src the source param data
-     * @param dst the destination param data
-     * @param parentScope the scope of the parent param
+     * @brief copies a param, skipping the sub-params and fields of its value
+     * that the client isn't authorized to access
+     *
+     * The source is walked once, copying only what the client can see. Each
+     * value is copied once, straight into dstValue; the copied sub-params have
+     * no value of their own, as their values are fields of their parent's.
+     *
+     * @param src the source param
+     * @param srcValue its value
+     * @param dst the destination param, which should be empty
+     * @param dstValue the destination of srcValue, which should be empty
+     * @param scope the scope of the source param
      * @param clientScopes the scopes of the client making the request
      */
-    void getParam_(DeviceModel::const_ParamAccessorData& src, DeviceModel::ParamAccessorData& dst,
-                   const std::string& parentScope, const std::vector<std::string>& clientScopes) const;
+    static void getParam_(const catena::Param& src, const catena::Value& srcValue, catena::Param& dst,
+                          catena::Value& dstValue, const std::string& scope,
+                          const std::vector<std::string>& clientScopes);
+
+    /**
+     * @brief write a struct or variant into the value, field by field
+     *
+     * @note call with the DeviceModel's mutex held
+     * @tparam V a reflectable struct or a variant
+     */
+    template <typename V> void setComposite_(const V& src) {
+        if constexpr (catena::full::has_getStructInfo<V>) {
+            const auto& structInfo = src.getStructInfo();
+            const char* base = reinterpret_cast<const char*>(&src);
+            auto* dstFields = value_.get().mutable_struct_value()->mutable_fields();
+            for (auto& field : structInfo.fields) {
+                const char* srcAddr = base + field.offset;
+                if (!dstFields->contains(field.name)) {
+                    dstFields->insert({field.name, StructField{}});
+                    *dstFields->at(field.name).mutable_value() = Value{};
+                    std::unique_ptr<ParamAccessor> sp = subParam<false>(field.name);
+                    field.wrapSetter(sp.get(), srcAddr);
+                } else {
+                    Value* dstField = dstFields->at(field.name).mutable_value();
+                    if (dstField->kind_case() == Value::KindCase::kStructValue) {
+                        // field is a struct
+                        std::unique_ptr<ParamAccessor> sp = subParam<false>(field.name);
+                        field.wrapSetter(sp.get(), srcAddr);
+                    } else {
+                        // field is a simple or simple array type
+                        setter_[dstField->kind_case()](dstField, srcAddr);
+                    }
+                }
+            }
+        } else if constexpr (catena::meta::is_variant<V>::value) {
+            const catena::full::VariantInfo& variantInfo = variantInfo_<V>();
+            Value& v = value_.get();
+            StructVariantValue* vv = v.mutable_struct_variant_value();
+            std::string* currentVariant = vv->mutable_struct_variant_type();
+            const std::string& variant = variantInfo.lookup[src.index()];
+            const std::unique_ptr<ParamAccessor> sp = subParam<false>(variant);
+            if (variant.compare(*currentVariant) != 0) {
+                // we need to change the variant type in the protobuf
+                *currentVariant = variant;
+            }
+            variantInfo.members.at(variant).wrapSetter(sp.get(), &src);
+        }
+    }
+
+    /**
+     * @brief emit a signal about a change to the value at idx, from the
+     * array's accessor if this one is to an element of it. Listeners are
+     * then always told the array's oid with the element's index, whether
+     * the element was set through its own path or through the array's.
+     *
+     * @param idx the index of the changed element, or kParamEnd
+     * @param emit called with the accessor and index to emit
+     */
+    template <typename EMIT> void emitChange_(ParamIndex idx, EMIT emit) {
+        if (index_ == kParamEnd) {
+            emit(*this, idx);
+            return;
+        }
+        // the element's path ends with its index
+        DeviceModel::ParamAccessorData pad{&param_.get(), &value_.get()};
+        ParamAccessor array(deviceModel_.get(), pad, oid_.substr(0, oid_.rfind('/')), scope_, kParamEnd);
+        emit(array, index_);
+    }
 
     /**
      * @brief checks if the src value is the correct type to set this parameter
@@ -715,6 +903,29 @@ class ParamAccessor {
      */
     bool sameKind(const Value& src, const ParamIndex idx) const;
 
+    /**
+     * @brief get the VariantInfo for a variant type, which is looked up in
+     * VariantInfoGetter just once per type
+     * @tparam V the variant type
+     */
+    template <typename V> static const catena::full::VariantInfo& variantInfo_() {
+        static const catena::full::VariantInfo& info = VariantInfoGetter::getInstance()[std::type_index(typeid(V))]();
+        return info;
+    }
+
+    /**
+     * @brief the functions that get and set values, by kind of value. They're
+     * built as constants, so they're ready before any accessor is constructed
+     */
+    static const Getter getter_;
+    static const Setter setter_;
+    static const GetterAt getterAt_;
+    static const SetterAt setterAt_;
+    static const ValueGetter valueGetter_;
+    static const ValueSetter valueSetter_;
+    static const ValueGetterAt valueGetterAt_;
+    static const ValueSetterAt valueSetterAt_;
+
     /** @brief a reference to the device model that contains accessed parameter */
     std::reference_wrapper<catena::full::DeviceModel> deviceModel_;
 
@@ -730,6 +941,9 @@ class ParamAccessor {
     /** @brief the accessed parameter's access scope */
     std::string scope_;
 
+    /** @brief the accessed element of an array parameter, or kParamEnd */
+    ParamIndex index_;
+
     /**
      * @brief a unique id (probability of non-uniqueness is approx 1:10^19).
      * Motivation - to allow for fast comparison of ParamAccessor objects and
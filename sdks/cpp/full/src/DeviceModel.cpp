@@ -22,11 +22,14 @@
 #include <google/protobuf/util/json_util.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 
 using catena::full::DeviceModel;
@@ -39,14 +42,22 @@ using google::protobuf::MapPair;
 auto jpopts = google::protobuf::util::JsonParseOptions{};
 
 
-DeviceModel::DeviceModel(const std::string &filename) : device_{} {
+DeviceModel::DeviceModel(const std::string &filename, const std::filesystem::path &cache) : device_{} {
     // initialize static attributes
     noValue_.set_undefined_value(catena::UndefinedValue());
 
+    if (!cache.empty() && ModelCache(cache).load(filename, device_)) {
+        // the cached model's templates were applied before it was cached,
+        // so this only finds the params whose templates couldn't be
+        resolveTemplates_();
+        return;
+    }
+
     // read in the top level file, code block used to minimize
     // lifespan of the imported file
+    std::vector<ModelCache::Source> sources(1);
     {
-        std::string file = catena::readFile(filename);
+        std::string file = ModelCache::readSource(filename, sources.front());
         auto status = google::protobuf::util::JsonStringToMessage(file, &device_, jpopts);
         if (!status.ok()) {
             std::stringstream err;
@@ -60,50 +71,164 @@ DeviceModel::DeviceModel(const std::string &filename) : device_{} {
     //
     std::filesystem::path current_folder(filename);
     current_folder = current_folder.remove_filename() /= std::string("params");
-    importSubParams_(current_folder, *device_.mutable_params());
+    importSubParams_(current_folder, *device_.mutable_params(), sources);
+
+    resolveTemplates_();
+
+    if (!cache.empty()) {
+        // not being able to cache the model doesn't stop us serving it
+        try {
+            ModelCache(cache).save(device_, sources);
+        } catch (const catena::exception_with_status &why) {
+            std::cerr << "could not cache the device model: " << why.what() << '\n';
+        }
+    }
 }
 
-void DeviceModel::importSubParams_(std::filesystem::path &current_folder, ParamsMap &params) {
-    for (auto it = params.begin(); it != params.end(); ++it) {
-        catena::Param &child = params.at(it->first);
-        if (child.has_import()) {
-            if (child.import().url().compare("include") == 0) {
-                // this is a local import, use the oid to create the filename
-                std::filesystem::path to_import(current_folder);
-                std::stringstream fn;
-                std::string imported;
-                fn << "param." << it->first << ".json";
-                to_import /= fn.str();
-                std::cout << "importing: " << to_import << '\n';
-
-                // import the file
-                imported = readFile(to_import);
-                // clear the "import" typing of the current param
-                // and overwrite with what we just imported
-                child.clear_import();
-                auto status = google::protobuf::util::JsonStringToMessage(imported, &child, jpopts);
-                if (!status.ok()) {
-                    std::stringstream err;
-                    err << "error importing " << to_import << ": " << status.message();
-                    BAD_STATUS(err.str(), catena::StatusCode::INVALID_ARGUMENT);
-                }
+namespace {
+/**
+ * @brief a param to be imported from a file
+ */
+struct ImportJob {
+    std::string oid;                 /**< the param's oid, relative to its parent */
+    std::filesystem::path folder;    /**< the folder its file is in */
+    std::filesystem::path file;      /**< the file */
+    catena::Param *param;            /**< where the imported param goes */
+    catena::Param imported;          /**< the param read from the file */
+    catena::full::ModelCache::Source source; /**< the file, as read */
+    std::string error;               /**< why the import failed, if it did */
+    catena::StatusCode status = catena::StatusCode::OK;
+};
+
+/**
+ * @brief call fn with each index from 0 to n - 1, sharing the calls between
+ * as many threads as the hardware supports
+ */
+template <typename F> void parallelFor(std::size_t n, F fn) {
+    std::atomic<std::size_t> next{0};
+    auto worker = [n, &fn, &next]() {
+        for (std::size_t i = next++; i < n; i = next++) {
+            fn(i);
+        }
+    };
 
-                // recurse to import any sub-params
-                if (child.params_size() > 0) {
-                    std::filesystem::path next_folder(current_folder);
-                    next_folder = next_folder /= it->first;
-                    importSubParams_(next_folder, *child.mutable_params());
-                }
-            } else if (child.import().url().compare("") != 0) {
-                /** @todo implement url imports*/
-                BAD_STATUS("Cannot (yet) import from urls, sorry.", catena::StatusCode::UNIMPLEMENTED);
+    std::size_t nThreads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), n);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < nThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @brief add a job for each of params that's imported from a file, in the
+ * params' order
+ */
+void collectImports(const std::filesystem::path &folder, DeviceModel::ParamsMap &params, std::vector<ImportJob> &jobs) {
+    for (auto &[oid, child] : params) {
+        if (!child.has_import()) {
+            continue;
+        }
+        if (child.import().url().compare("include") == 0) {
+            // this is a local import, use the oid to create the filename
+            std::stringstream fn;
+            fn << "param." << oid << ".json";
+            ImportJob &job = jobs.emplace_back();
+            job.oid = oid;
+            job.folder = folder;
+            job.file = folder / fn.str();
+            job.param = &child;
+        } else if (child.import().url().compare("") != 0) {
+            /** @todo implement url imports*/
+            BAD_STATUS("Cannot (yet) import from urls, sorry.", catena::StatusCode::UNIMPLEMENTED);
+        }
+    }
+}
+
+/**
+ * @brief read and parse the file of each job in parallel
+ */
+void runImports(std::vector<ImportJob> &jobs) {
+    parallelFor(jobs.size(), [&jobs](std::size_t i) {
+        ImportJob &job = jobs[i];
+        try {
+            std::string imported = catena::full::ModelCache::readSource(job.file, job.source);
+            auto status = google::protobuf::util::JsonStringToMessage(imported, &job.imported, jpopts);
+            if (!status.ok()) {
+                std::stringstream err;
+                err << "error importing " << job.file << ": " << status.message();
+                job.error = err.str();
+                job.status = catena::StatusCode::INVALID_ARGUMENT;
             }
+        } catch (const std::exception &why) {
+            std::stringstream err;
+            err << "error reading " << job.file << ": " << why.what();
+            job.error = err.str();
+            job.status = catena::StatusCode::NOT_FOUND;
         }
+    });
+}
+
+/**
+ * @brief add the template_oids of p and its sub-params to templateOids
+ */
+void collectTemplateOids(const catena::Param &p, std::unordered_set<std::string> &templateOids) {
+    if (!p.template_oid().empty()) {
+        templateOids.insert(p.template_oid());
+    }
+    for (const auto &[oid, child] : p.params()) {
+        collectTemplateOids(child, templateOids);
+    }
+}
+
+/**
+ * @brief a top-level param whose templates are to be applied
+ */
+struct TemplateJob {
+    TemplateJob(const std::string *oid, catena::Param *param, bool isTemplate)
+        : oid{oid}, param{param}, isTemplate{isTemplate} {}
+
+    const std::string *oid;  /**< the param's oid */
+    catena::Param *param;    /**< the param */
+    bool isTemplate;         /**< whether other params are made from it */
+    catena::Param filled;    /**< the filled copy of a template */
+    bool ok = false;         /**< whether its templates could be applied */
+};
+}  // namespace
+
+void DeviceModel::importSubParams_(std::filesystem::path &current_folder, ParamsMap &params,
+                                   std::vector<ModelCache::Source> &sources) {
+    // a param's file says which of its sub-params are imported too, so the
+    // tree is imported a level at a time. The files of each level are read
+    // and parsed in parallel, then merged into the model in order.
+    std::vector<ImportJob> jobs;
+    collectImports(current_folder, params, jobs);
+    while (!jobs.empty()) {
+        runImports(jobs);
+
+        std::vector<ImportJob> nextLevel;
+        for (ImportJob &job : jobs) {
+            if (job.status != catena::StatusCode::OK) {
+                throw catena::exception_with_status(job.error, job.status);
+            }
+            std::cout << "importing: " << job.file << '\n';
+            sources.push_back(std::move(job.source));
+            // overwrite the "import" typing of the param with what we imported
+            *job.param = std::move(job.imported);
+
+            // look for imports in its sub-params
+            if (job.param->params_size() > 0) {
+                collectImports(job.folder / job.oid, *job.param->mutable_params(), nextLevel);
+            }
+        }
+        jobs = std::move(nextLevel);
     }
 }
 
 const catena::Device &catena::full::DeviceModel::device() const {
-    std::lock_guard<Mutex> lock(mutex_);
     return device_;
 }
 
@@ -120,16 +245,39 @@ const catena::Device &catena::full::DeviceModel::device() const {
 catena::Value catena::full::DeviceModel::noValue_;
 
 std::unique_ptr<ParamAccessor> catena::full::DeviceModel::param(const std::string &jptr) {
+    // fast path, the param has been resolved before
+    {
+        std::shared_lock<std::shared_mutex> cacheLock(pathCacheMutex_);
+        auto it = pathCache_.find(jptr);
+        if (it != pathCache_.end() && (!it->second.nested || it->second.epoch == valueEpoch_)) {
+            ParamAccessorData pad{it->second.param, it->second.value};
+            return std::make_unique<ParamAccessor>(*this, pad, jptr, it->second.scope, it->second.index);
+        }
+    }
+
     std::lock_guard<Mutex> lock(mutex_);
     catena::common::Path path_(jptr);
+    ResolvedParam resolved = resolve_(path_);
+    ParamAccessorData pad{resolved.param, resolved.value};
+    auto ans = std::make_unique<ParamAccessor>(*this, pad, jptr, resolved.scope, resolved.index);
+
+    std::unique_lock<std::shared_mutex> cacheLock(pathCacheMutex_);
+    pathCache_.insert_or_assign(jptr, std::move(resolved));
+    return ans;
+}
+
+DeviceModel::ResolvedParam DeviceModel::resolve_(catena::common::Path &path_) {
+    // remember the epoch before walking, in case our values are replaced
+    // before the result is cached
+    uint64_t epoch = valueEpoch_;
 
     // get our oid and look for it in the params map
     catena::common::Path::Segment segment = path_.pop_front();
 
-    if (!std::holds_alternative<std::string>(segment)) {
+    if (!std::holds_alternative<std::string_view>(segment)) {
         BAD_STATUS("expected oid, got an index", catena::StatusCode::INVALID_ARGUMENT);
     }
-    std::string oid(std::get<std::string>(segment));
+    std::string oid(std::get<std::string_view>(segment));
 
     if (!device_.mutable_params()->contains(oid)) {
         std::stringstream msg;
@@ -139,86 +287,321 @@ std::unique_ptr<ParamAccessor> catena::full::DeviceModel::param(const std::strin
 
     // build the data needed to create the ParamAccessor
     catena::Param &p = device_.mutable_params()->at(oid);
+    templateOnce_(p, oid);
+
+    ResolvedParam ans{&p, p.has_value() ? p.mutable_value() : &noValue_,
+                      p.access_scope() == "" ? device_.default_scope() : p.access_scope(),
+                      catena::full::kParamEnd, false, epoch};
+
+    while (path_.size()) {
+        if (std::holds_alternative<std::string_view>(path_.front())) {
+            std::string oid(std::get<std::string_view>(path_.pop_front()));
+            // same navigation as ParamAccessor::subParam, without building
+            // an accessor at each level
+            if (!ans.param->mutable_params()->contains(oid)) {
+                BAD_STATUS("subParam called on non-existent field", catena::StatusCode::INVALID_ARGUMENT);
+            }
+            catena::Param &child = ans.param->mutable_params()->at(oid);
+            catena::Value &value = *ans.value;
+            if (ans.index == catena::full::kParamEnd && value.kind_case() == Value::KindCase::kStructValue) {
+                if (!value.struct_value().fields().contains(oid)) {
+                    BAD_STATUS("subParam called on non-existent field", catena::StatusCode::INVALID_ARGUMENT);
+                }
+                ans.value = value.mutable_struct_value()->mutable_fields()->at(oid).mutable_value();
+            } else if (ans.index == catena::full::kParamEnd && value.kind_case() == Value::KindCase::kStructVariantValue) {
+                ans.value = value.mutable_struct_variant_value()->mutable_value();
+            } else if (value.kind_case() == Value::KindCase::kStructArrayValues) {
+                // field of the element we indexed, the array's sub-params
+                // describe its elements
+                auto *fields = value.mutable_struct_array_values()->mutable_struct_values(ans.index)->mutable_fields();
+                if (!fields->contains(oid)) {
+                    BAD_STATUS("subParam called on non-existent field", catena::StatusCode::INVALID_ARGUMENT);
+                }
+                ans.value = fields->at(oid).mutable_value();
+            } else if (value.kind_case() == Value::KindCase::kStructVariantArrayValues) {
+                ans.value = value.mutable_struct_variant_array_values()->mutable_struct_variants(ans.index)->mutable_value();
+            } else {
+                BAD_STATUS("subParam called on non-struct or variant type", catena::StatusCode::INVALID_ARGUMENT);
+            }
+            ans.param = &child;
+            if (child.access_scope() != "") {
+                ans.scope = child.access_scope();
+            }
+            ans.index = catena::full::kParamEnd;
+            ans.nested = true;
+        } else if (std::holds_alternative<catena::common::Path::Index>(path_.front())) {
+            auto idx = std::get<catena::common::Path::Index>(path_.pop_front());
+            if (ans.index != catena::full::kParamEnd || !catena::full::isList(*ans.value)) {
+                BAD_STATUS("cannot index into non-array type", catena::StatusCode::INVALID_ARGUMENT);
+            }
+            std::size_t size = catena::full::arraySize(*ans.value);
+            if (idx >= size) {
+                std::stringstream err;
+                err << "array index is out of bounds, " << idx << " >= " << size;
+                BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
+            }
+            // the accessor is to the element, which is written in place
+            ans.index = static_cast<catena::full::ParamIndex>(idx);
+        } else {
+            BAD_STATUS("expected oid or index", catena::StatusCode::INVALID_ARGUMENT);
+        }
+    }
+
+    return ans;
+}
+
+void DeviceModel::templateOnce_(catena::Param &p, const std::string &oid) {
     // put any one-time behaviour here
     if (!accessed_.contains(oid)) {
         // look for missing fields in the template
         checkTemplateData_(p, p.template_oid());
-        checkSubParamTemplates_(p, oid);
+        checkSubParamTemplates_(p);
         accessed_.insert(oid); // mark this param as templated
     }
+}
 
-    ParamAccessorData pad;
-    std::get<0>(pad) = &p;
-    std::get<1>(pad) = (p.has_value() ? p.mutable_value() : &noValue_);
-    std::string scope = p.access_scope() == "" ? device_.default_scope() : p.access_scope();
+void DeviceModel::resolveTemplates_() {
+    std::unordered_set<std::string> templateOids;
+    for (const auto &[oid, p] : device_.params()) {
+        collectTemplateOids(p, templateOids);
+    }
+    shareTemplateConstraints_(templateOids);
 
-    auto ans = std::make_unique<ParamAccessor>(*this, pad, jptr, scope);
+    // the top-level params that templates are found in
+    std::unordered_set<std::string> roots;
+    for (const std::string &toid : templateOids) {
+        try {
+            catena::common::Path path(toid);
+            if (path.size() && std::holds_alternative<std::string_view>(path.front())) {
+                roots.emplace(std::get<std::string_view>(path.front()));
+            }
+        } catch (const catena::exception_with_status &) {
+            // reported when the param using it is accessed
+        }
+    }
 
-    while (path_.size()) {
-        if (std::holds_alternative<std::string>(path_.front())) {
-            std::string oid(std::get<std::string>(path_.pop_front()));
-            ans = ans->subParam<false>(oid);
-        } else if (std::holds_alternative<std::deque<std::string>::size_type>(path_.front())) {
-            BAD_STATUS("indexing not yet implemented", catena::StatusCode::UNIMPLEMENTED);
-            // auto idx = std::get<std::deque<std::string>::size_type>(path_.pop_front());
-            // ans = ans->at<false>(idx);
-        } else {
-            BAD_STATUS("expected oid or index", catena::StatusCode::INVALID_ARGUMENT);
+    std::vector<TemplateJob> jobs;
+    jobs.reserve(device_.params_size());
+    for (auto &[oid, p] : *device_.mutable_params()) {
+        jobs.emplace_back(&oid, &p, roots.contains(oid));
+    }
+    parallelFor(jobs.size(), [this, &jobs](std::size_t i) {
+        TemplateJob &job = jobs[i];
+        catena::Param *p = job.param;
+        if (job.isTemplate) {
+            // other threads may be reading it
+            job.filled = *p;
+            p = &job.filled;
+        }
+        try {
+            checkTemplateData_(*p, p->template_oid());
+            checkSubParamTemplates_(*p);
+            job.ok = true;
+        } catch (const std::exception &) {
+            // templateOnce_ will try again, and report why, on first access
+        }
+    });
+
+    for (TemplateJob &job : jobs) {
+        if (!job.ok) {
+            continue;
+        }
+        if (job.isTemplate) {
+            *job.param = std::move(job.filled);
         }
+        accessed_.insert(*job.oid);
     }
+}
 
-    return ans;
+void DeviceModel::shareTemplateConstraints_(const std::unordered_set<std::string> &templateOids) {
+    for (const std::string &toid : templateOids) {
+        // find the template, or the array it's an element of, and name its
+        // shared constraint after its path
+        catena::Param *t = nullptr;
+        std::string key;
+        try {
+            catena::common::Path path(toid);
+            ParamsMap *params = device_.mutable_params();
+            while (path.size() && std::holds_alternative<std::string_view>(path.front())) {
+                std::string oid(std::get<std::string_view>(path.pop_front()));
+                auto it = params->find(oid);
+                if (it == params->end()) {
+                    t = nullptr;
+                    break;
+                }
+                t = &it->second;
+                params = t->mutable_params();
+                key += key.empty() ? oid : "." + oid;
+            }
+        } catch (const catena::exception_with_status &) {
+            t = nullptr;
+        }
+        if (t == nullptr || !t->has_constraint() || t->constraint().kind_case() == catena::Constraint::kRefOid) {
+            continue;
+        }
+
+        // leave the model's own shared constraints alone
+        auto [it, added] = device_.mutable_constraints()->insert({key, t->constraint()});
+        if (!added) {
+            continue;
+        }
+        catena::Constraint ref;
+        ref.set_type(t->constraint().type());
+        ref.set_ref_oid(key);
+        *t->mutable_constraint() = std::move(ref);
+    }
+}
+
+std::shared_ptr<const DeviceModel::StreamIndex> DeviceModel::streamIndex_() {
+    std::lock_guard<Mutex> lock(mutex_);
+    if (builtStreamIndex_) {
+        return builtStreamIndex_;
+    }
+
+    auto index = std::make_shared<StreamIndex>();
+    index->params.reserve(device_.params_size());
+    std::unordered_map<std::string, uint32_t> scopeIds;
+    for (auto &[oid, p] : *device_.mutable_params()) {
+        templateOnce_(p, oid);
+        const std::string &scope = p.access_scope() == "" ? device_.default_scope() : p.access_scope();
+        auto [it, added] = scopeIds.try_emplace(scope, static_cast<uint32_t>(index->scopes.size()));
+        if (added) {
+            index->scopes.push_back(scope);
+        }
+        index->params.push_back({"/" + oid, it->second, &p, p.has_value() ? p.mutable_value() : &noValue_});
+    }
+    builtStreamIndex_ = std::move(index);
+    return builtStreamIndex_;
+}
+
+catena::Param DeviceModel::addParam(const std::string &jptr, Param &&param) {
+    std::lock_guard<Mutex> lock(mutex_);
+    catena::common::Path path_(jptr);
+    if (path_.size() != 1 || !std::holds_alternative<std::string_view>(path_.front())) {
+        BAD_STATUS("params can only be added at the top level", catena::StatusCode::UNIMPLEMENTED);
+    }
+    std::string oid(std::get<std::string_view>(path_.front()));
+
+    if (device_.params().contains(oid)) {
+        std::stringstream msg;
+        msg << "param " << std::quoted(oid) << " already exists";
+        BAD_STATUS(msg.str(), catena::StatusCode::ALREADY_EXISTS);
+    }
+    catena::Param &added = (*device_.mutable_params())[oid];
+    added = std::move(param);
+    clearPathCache_();
+    builtStreamIndex_.reset();
+    return added;
+}
+
+void DeviceModel::clearPathCache_() {
+    std::unique_lock<std::shared_mutex> cacheLock(pathCacheMutex_);
+    pathCache_.clear();
 }
 
-void DeviceModel::checkSubParamTemplates_(catena::Param &p, const std::string &p_oid) {
+void DeviceModel::checkSubParamTemplates_(catena::Param &p) const {
     if (p.params().empty()) { return; }
 
     for (auto &[child_oid, child_param] : *p.mutable_params()) {
-        std::string qualified_child_oid = p_oid + "/" + child_oid;
-        if (accessed_.contains(qualified_child_oid)) {
-            continue;
-        }
         checkTemplateData_(child_param, child_param.template_oid());
         // recurse to check the child's children
-        checkSubParamTemplates_(child_param, qualified_child_oid);
-        // update the parent's value field
-        catena::StructField field;
-        field.mutable_value()->CopyFrom(child_param.value());
-        p.mutable_value()->mutable_struct_value()->mutable_fields()->insert({child_oid, field});
-        // if this subparam is ever retrieved alone, it will be considered built
-        accessed_.insert(qualified_child_oid); 
+        checkSubParamTemplates_(child_param);
+        // update the parent's value field, if it's a struct. The sub-params
+        // of arrays and variants describe their elements and alternatives,
+        // which mustn't be overwritten by a struct value
+        if (p.value().kind_case() == Value::KindCase::kStructValue ||
+            (!p.has_value() && p.type() == catena::ParamType::STRUCT)) {
+            auto *fields = p.mutable_value()->mutable_struct_value()->mutable_fields();
+            if (!fields->contains(child_oid)) {
+                // fields the value already has are kept
+                (*fields)[child_oid].mutable_value()->CopyFrom(child_param.value());
+            }
+        }
+    }
+}
+
+/**
+ * @brief make a template from an element of an array param
+ *
+ * @param array the array param
+ * @param idx the index of the element
+ * @return a copy of array, with the type of its elements, and the element as
+ * its value
+ */
+static catena::Param elementTemplate(const catena::Param &array, catena::common::Path::Index idx) {
+    if (!catena::full::isList(array.value())) {
+        BAD_STATUS("cannot index into non-array type for template_oid", catena::StatusCode::INVALID_ARGUMENT);
+    }
+    std::size_t size = catena::full::arraySize(array.value());
+    if (idx >= size) {
+        std::stringstream err;
+        err << "template_oid array index is out of bounds, " << idx << " >= " << size;
+        BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
+    }
+
+    catena::Param ans = array;
+    const catena::Value &value = array.value();
+    catena::Value *dst = ans.mutable_value();
+    switch (value.kind_case()) {
+        case catena::Value::KindCase::kInt32ArrayValues:
+            ans.set_type(catena::ParamType::INT32);
+            dst->set_int32_value(value.int32_array_values().ints(idx));
+            break;
+        case catena::Value::KindCase::kFloat32ArrayValues:
+            ans.set_type(catena::ParamType::FLOAT32);
+            dst->set_float32_value(value.float32_array_values().floats(idx));
+            break;
+        case catena::Value::KindCase::kStringArrayValues:
+            ans.set_type(catena::ParamType::STRING);
+            dst->set_string_value(value.string_array_values().strings(idx));
+            break;
+        case catena::Value::KindCase::kStructArrayValues:
+            ans.set_type(catena::ParamType::STRUCT);
+            *dst->mutable_struct_value() = value.struct_array_values().struct_values(idx);
+            break;
+        case catena::Value::KindCase::kStructVariantArrayValues:
+            ans.set_type(catena::ParamType::STRUCT_VARIANT);
+            *dst->mutable_struct_variant_value() = value.struct_variant_array_values().struct_variants(idx);
+            break;
+        default:
+            break;
     }
+    return ans;
 }
 
-void DeviceModel::checkTemplateData_(catena::Param &p, const std::string &path) {
+void DeviceModel::checkTemplateData_(catena::Param &p, const std::string &path) const {
     if (path.empty()) { return; }
 
     catena::common::Path template_path_(path);
     catena::common::Path::Segment segment = template_path_.pop_front();
-    if (!std::holds_alternative<std::string>(segment)) {
+    if (!std::holds_alternative<std::string_view>(segment)) {
         BAD_STATUS("expected template_oid, got an index", catena::StatusCode::INVALID_ARGUMENT);
     }
-    std::string toid(std::get<std::string>(segment));
+    std::string toid(std::get<std::string_view>(segment));
 
-    if (!device_.mutable_params()->contains(toid)) {
+    if (!device_.params().contains(toid)) {
         std::stringstream msg;
         msg << "template " << std::quoted(toid) << " not found";
         BAD_STATUS(msg.str(), catena::StatusCode::NOT_FOUND);
     }
     
     // follow the template_oid as far as it goes
-    std::reference_wrapper<catena::Param> t = std::ref(device_.mutable_params()->at(toid));
+    std::reference_wrapper<const catena::Param> t = std::cref(device_.params().at(toid));
+    catena::Param element; // the template, if it's an element of an array
     while (template_path_.size()) {
-        if (std::holds_alternative<std::string>(template_path_.front())) {
+        if (std::holds_alternative<std::string_view>(template_path_.front())) {
             if (t.get().value().kind_case() != Value::KindCase::kStructValue && 
                 t.get().value().kind_case() != Value::KindCase::kStructVariantValue) {
                 BAD_STATUS("cannot subparam into non-struct or variant type for template_oid", catena::StatusCode::INVALID_ARGUMENT);
             }
-            std::string toid(std::get<std::string>(template_path_.pop_front()));
-            t = std::ref(t.get().mutable_params()->at(toid));
-        } else if (std::holds_alternative<std::deque<std::string>::size_type>(template_path_.front())) {
-            // rebind t to the indexed param from the array when implementing indexing
-            BAD_STATUS("indexing into template_oid not yet implemented", catena::StatusCode::UNIMPLEMENTED);
+            std::string toid(std::get<std::string_view>(template_path_.pop_front()));
+            t = std::cref(t.get().params().at(toid));
+        } else if (std::holds_alternative<catena::common::Path::Index>(template_path_.front())) {
+            // rebind t to the indexed element of the array
+            auto idx = std::get<catena::common::Path::Index>(template_path_.pop_front());
+            catena::Param next = elementTemplate(t.get(), idx);
+            element = std::move(next);
+            t = std::cref(element);
         } else {
             BAD_STATUS("expected oid or index in template_oid", catena::StatusCode::INVALID_ARGUMENT);
         }
@@ -290,7 +673,7 @@ void DeviceModel::checkTemplateData_(catena::Param &p, const std::string &path)
 DeviceStream::DeviceStream(catena::full::DeviceModel &dm) 
     : deviceModel_{dm}, component_{}, nextType_{ComponentType::kBasicDeviceInfo}{
         const Device& device = deviceModel_.get().device();
-        paramIter_ = device.params().begin();
+        params_ = deviceModel_.get().streamIndex_();
         constraintIter_ = device.constraints().begin();
         menuGroupIter_ = device.menu_groups().begin();
         if (menuGroupIter_ != device.menu_groups().end()){
@@ -302,6 +685,11 @@ DeviceStream::DeviceStream(catena::full::DeviceModel &dm)
 
 void DeviceStream::attachClientScopes(std::vector<std::string>& scopes){
     clientScopes_ = &scopes;
+    // work out which of the params' scopes the client has, once
+    scopeAllowed_.assign(params_->scopes.size(), false);
+    for (std::size_t i = 0; i < params_->scopes.size(); ++i) {
+        scopeAllowed_[i] = !scopes.empty() && ParamAccessor::checkScope(scopes, params_->scopes[i]);
+    }
 }
 
 bool DeviceStream::hasNext() const {
@@ -347,14 +735,12 @@ const catena::DeviceComponent& DeviceStream::next(){
 void DeviceStream::setNextType_(){
     const Device& device = deviceModel_.get().device();
     // Skip over params that are not in the client's scope
-    std::unique_ptr<ParamAccessor> p;
-    while(paramIter_ != device.params().end()){
-        p = deviceModel_.get().param("/" + paramIter_->first);
-        if(p->checkScope(*clientScopes_) == true) {
+    while(paramPos_ < params_->params.size()){
+        if(scopeAllowed_[params_->params[paramPos_].scope]) {
             nextType_ = ComponentType::kParam;
             return; 
         }
-        paramIter_++;
+        paramPos_++;
     }
     if(constraintIter_ != device.constraints().end()){
         nextType_ = ComponentType::kConstraint;
@@ -398,15 +784,19 @@ catena::DeviceComponent& DeviceStream::basicDeviceInfo_(){
 
 catena::DeviceComponent& DeviceStream::paramComponent_(){
     catena::DeviceComponent_ComponentParam* param = component_.mutable_param();
-    std::unique_ptr<ParamAccessor> p = deviceModel_.get().param("/" + paramIter_->first);
-    try {
-        p->getParam(param, *clientScopes_); // get the param
-    } catch(catena::exception_with_status& why){
-        // Error is thrown for clients without authorization
-        // Don't need to send any info to unauthorized clients
-    } 
+    const DeviceModel::StreamIndex::Entry& entry = params_->params[paramPos_];
+    param->Clear();
+    param->set_oid(entry.oid);
+    {
+        // copy the param, skipping sub-params the client can't access.
+        // setNextType_ has already checked that it can access the param.
+        std::shared_lock<DeviceModel::Mutex> lock(deviceModel_.get().mutex_);
+        catena::Param *dst = param->mutable_param();
+        ParamAccessor::getParam_(*entry.param, *entry.value, *dst, *dst->mutable_value(), params_->scopes[entry.scope],
+                                 *clientScopes_);
+    }
   
-    paramIter_++;
+    paramPos_++;
     setNextType_();
     return component_;
 }
@@ -0,0 +1,313 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <full/include/ModelCache.h>
+#include <Status.h>
+#include <utils.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <system_error>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using catena::full::ModelCache;
+
+namespace {
+
+/**
+ * @brief start of the manifest's first line, bump the version when the format
+ * of the cache changes. Changes to the catena::Device schema are caught by the
+ * schema hash that follows it.
+ */
+const std::string kManifestHeader("catena-model-cache 3");
+
+/**
+ * @brief the largest serialized device that can be cached, as ParseFromArray
+ * takes its size as an int
+ */
+constexpr uintmax_t kMaxDeviceSize = std::numeric_limits<int>::max();
+
+constexpr uint64_t kFnvBasis = 14695981039346656037ull;
+
+/**
+ * @brief continue a 64 bit FNV-1a hash over some data
+ */
+uint64_t fnv1a(uint64_t hash, const char* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief hash a file's content
+ */
+uint64_t hashFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    uint64_t hash = kFnvBasis;
+    char buf[64 * 1024];
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0) {
+        hash = fnv1a(hash, buf, file.gcount());
+    }
+    return hash;
+}
+
+/**
+ * @brief hash the descriptors of catena::Device and the files it depends on,
+ * so that a cache written with a different schema is stale
+ */
+uint64_t schemaHash() {
+    static const uint64_t hash = [] {
+        using google::protobuf::FileDescriptor;
+        uint64_t ans = kFnvBasis;
+        std::vector<const FileDescriptor*> files{catena::Device::descriptor()->file()};
+        std::unordered_set<const FileDescriptor*> seen(files.begin(), files.end());
+        while (!files.empty()) {
+            const FileDescriptor* file = files.back();
+            files.pop_back();
+            google::protobuf::FileDescriptorProto proto;
+            file->CopyTo(&proto);
+            std::string serialized = proto.SerializeAsString();
+            ans = fnv1a(ans, serialized.data(), serialized.size());
+            for (int i = 0; i < file->dependency_count(); ++i) {
+                if (seen.insert(file->dependency(i)).second) {
+                    files.push_back(file->dependency(i));
+                }
+            }
+        }
+        return ans;
+    }();
+    return hash;
+}
+
+/**
+ * @brief the first line of the manifest
+ */
+std::string manifestHeader() {
+    std::stringstream header;
+    header << kManifestHeader << ' ' << std::hex << schemaHash();
+    return header.str();
+}
+
+int64_t mtimeOf(const std::filesystem::path& path, std::error_code& ec) {
+    return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+}
+
+/**
+ * @brief parse the serialized device at path into dst, mapping it into memory
+ * rather than copying it where that's supported
+ *
+ * @return false if the file's size or hash isn't what the manifest recorded,
+ * or it can't be parsed
+ */
+bool parseDevice(const std::filesystem::path& path, uintmax_t size, uint64_t hash, catena::Device& dst) {
+#ifdef _WIN32
+    std::string serialized = catena::readFile(path);
+    return serialized.size() == size && fnv1a(kFnvBasis, serialized.data(), serialized.size()) == hash &&
+           dst.ParseFromString(serialized);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) { return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uintmax_t>(st.st_size) != size) {
+        close(fd);
+        return false;
+    }
+    if (size == 0) {
+        close(fd);
+        dst.Clear();
+        return hash == kFnvBasis;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) { return false; }
+    bool ok = fnv1a(kFnvBasis, static_cast<const char*>(data), size) == hash &&
+              dst.ParseFromArray(data, static_cast<int>(size));
+    munmap(data, size);
+    return ok;
+#endif
+}
+
+/**
+ * @brief a temporary file name next to path, unique to this process and call
+ */
+std::filesystem::path tempPath(const std::filesystem::path& path) {
+    static std::atomic<uint64_t> counter{0};
+#ifdef _WIN32
+    int pid = _getpid();
+#else
+    pid_t pid = getpid();
+#endif
+    std::filesystem::path tmp(path);
+    tmp += "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
+    return tmp;
+}
+
+/**
+ * @brief write a file via a temporary one, so that it's either the old or
+ * the new version if interrupted. The temporary file is unique, so processes
+ * writing the same file at once don't write into each other's.
+ */
+template <typename WRITE> void replaceFile(const std::filesystem::path& path, WRITE write) {
+    std::filesystem::path tmp = tempPath(path);
+    {
+        std::ofstream file(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file || !write(file) || !file.flush()) {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            std::stringstream why;
+            why << __PRETTY_FUNCTION__ << "\ncould not write '" << tmp.string() << "'";
+            throw catena::exception_with_status(why.str(), catena::StatusCode::INTERNAL);
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::error_code removeEc;
+        std::filesystem::remove(tmp, removeEc);
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\ncould not replace '" << path.string() << "': " << ec.message();
+        throw catena::exception_with_status(why.str(), catena::StatusCode::INTERNAL);
+    }
+}
+
+}  // namespace
+
+std::string ModelCache::readSource(const std::filesystem::path& path, Source& src) {
+    std::error_code ec;
+    src.path = std::filesystem::absolute(path, ec);
+    src.mtime = mtimeOf(path, ec);
+    std::string content = catena::readFile(path);
+    src.size = content.size();
+    src.hash = fnv1a(kFnvBasis, content.data(), content.size());
+    return content;
+}
+
+ModelCache::ModelCache(const std::filesystem::path& path) : path_{path}, manifest_{path} {
+    manifest_ += ".manifest";
+}
+
+bool ModelCache::readManifest_(std::vector<Source>& sources, uintmax_t& deviceSize, uint64_t& deviceHash) const {
+    std::ifstream file(manifest_);
+    std::string line;
+    if (!std::getline(file, line) || line != manifestHeader()) {
+        return false;
+    }
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    // the size and hash of the serialized device
+    std::istringstream deviceLine(line);
+    if (!(deviceLine >> deviceSize >> std::hex >> deviceHash) || deviceSize > kMaxDeviceSize) {
+        return false;
+    }
+    // then a line per source: hash mtime size path
+    while (std::getline(file, line)) {
+        std::istringstream entry(line);
+        Source src;
+        std::string path;
+        if (!(entry >> std::hex >> src.hash >> std::dec >> src.mtime >> src.size) || entry.get() != ' ' ||
+            !std::getline(entry, path)) {
+            return false;
+        }
+        src.path = path;
+        sources.push_back(std::move(src));
+    }
+    return !sources.empty();
+}
+
+bool ModelCache::load(const std::filesystem::path& source, catena::Device& dst) const {
+    std::vector<Source> sources;
+    uintmax_t deviceSize = 0;
+    uint64_t deviceHash = 0;
+    if (!readManifest_(sources, deviceSize, deviceHash)) {
+        return false;
+    }
+
+    // is it a cache of this model
+    std::error_code ec;
+    if (sources.front().path != std::filesystem::absolute(source, ec)) {
+        return false;
+    }
+
+    // have any of the model's files changed
+    for (const Source& src : sources) {
+        uintmax_t size = std::filesystem::file_size(src.path, ec);
+        if (ec) { return false; }
+        int64_t mtime = mtimeOf(src.path, ec);
+        if (ec) { return false; }
+        if (size != src.size) {
+            return false;
+        }
+        if (mtime != src.mtime && hashFile(src.path) != src.hash) {
+            // touched and changed
+            return false;
+        }
+    }
+
+    // and is the device the one the manifest was written for, in full
+    if (!parseDevice(path_, deviceSize, deviceHash, dst)) {
+        dst.Clear();
+        return false;
+    }
+    return true;
+}
+
+void ModelCache::save(const catena::Device& device, const std::vector<Source>& sources) const {
+    std::string serialized;
+    if (!device.SerializeToString(&serialized)) {
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\ncould not serialize the device";
+        throw catena::exception_with_status(why.str(), catena::StatusCode::INTERNAL);
+    }
+    if (serialized.size() > kMaxDeviceSize) {
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\nthe serialized device is too large to cache: " << serialized.size();
+        throw catena::exception_with_status(why.str(), catena::StatusCode::INTERNAL);
+    }
+
+    std::stringstream manifest;
+    manifest << manifestHeader() << '\n' << serialized.size() << ' ' << std::hex
+             << fnv1a(kFnvBasis, serialized.data(), serialized.size()) << std::dec << '\n';
+    for (const Source& src : sources) {
+        manifest << std::hex << src.hash << std::dec << ' ' << src.mtime << ' ' << src.size << ' ' << src.path.string() << '\n';
+    }
+
+    // the manifest is what makes the cache valid, so remove it while the
+    // device is replaced, and write it last. If another process is saving at
+    // the same time, its device may end up with this manifest, which the
+    // device's hash then rejects.
+    std::error_code ec;
+    std::filesystem::remove(manifest_, ec);
+    replaceFile(path_, [&serialized](std::ofstream& file) {
+        return static_cast<bool>(file.write(serialized.data(), serialized.size()));
+    });
+    replaceFile(manifest_, [&manifest](std::ofstream& file) { return static_cast<bool>(file << manifest.str()); });
+}
@@ -182,37 +182,51 @@ valueSetterAt.addFunction(kind_case, [](Value &dst, const Value &src, ParamIndex
     dst.mutable_array_val_method()->mutable_method()->at(idx) = src.value_method(); \
 })
 
-// ParamAccessor::Setter::Protector setterProtector;
-// static ParamAccessor::Setter setter(setterProtector);
-// ParamAccessor::Getter::Protector getterProtector;
-// static ParamAccessor::Getter getter(getterProtector);
+/**
+ * @brief the constraint to apply to param, following a reference to one of
+ * the device's shared constraints.
+ */
+static const catena::Constraint &resolveConstraint(const catena::Device &device, const catena::Param &param) {
+    const catena::Constraint &constraint = param.constraint();
+    if (constraint.kind_case() != catena::Constraint::kRefOid) {
+        return constraint;
+    }
+    auto it = device.constraints().find(constraint.ref_oid());
+    if (it == device.constraints().end()) {
+        std::stringstream err;
+        err << "shared constraint not found: " << constraint.ref_oid() << '\n';
+        BAD_STATUS((err.str()), catena::StatusCode::NOT_FOUND);
+    }
+    return it->second;
+}
 
-int applyIntConstraint(catena::Param &param, int v) {
+int applyIntConstraint(const catena::Device &device, catena::Param &param, int v) {
     /// @todo: add warning log for invalid constraint
     if (param.has_constraint()) {
         // apply the constraint
-        int constraint_type = param.constraint().type();
+        const catena::Constraint &constraint = resolveConstraint(device, param);
+        int constraint_type = constraint.type();
 
         switch (constraint_type) {
             case catena::Constraint_ConstraintType::Constraint_ConstraintType_INT_RANGE:
-                v = std::clamp(v, param.constraint().int32_range().min_value(),
-                               param.constraint().int32_range().max_value());
+                v = std::clamp(v, constraint.int32_range().min_value(),
+                               constraint.int32_range().max_value());
                 break;
             case catena::Constraint_ConstraintType::Constraint_ConstraintType_INT_CHOICE:
-                if (std::find_if(param.constraint().int32_choice().choices().begin(),
-                                 param.constraint().int32_choice().choices().end(),
+                if (std::find_if(constraint.int32_choice().choices().begin(),
+                                 constraint.int32_choice().choices().end(),
                                  [&](catena::Int32ChoiceConstraint_IntChoice const &c) {
                                      return c.value() == v;
-                                 }) == param.constraint().int32_choice().choices().end()) {
+                                 }) == constraint.int32_choice().choices().end()) {
 
                     // if value is not in constraint, choose first item in list
-                    v = param.constraint().int32_choice().choices(0).value();
+                    v = constraint.int32_choice().choices(0).value();
                 }
                 break;
             case catena::Constraint_ConstraintType::Constraint_ConstraintType_ALARM_TABLE: {
                 // e.g. for bit_value of 1 and 3, bit_location = 1010
                 int bit_location = 0;
-                for (const auto &it : param.constraint().alarm_table().alarms()) {
+                for (const auto &it : constraint.alarm_table().alarms()) {
                     bit_location |= (1 << it.bit_value());
                 }
 
@@ -236,34 +250,35 @@ int applyIntConstraint(catena::Param &param, int v) {
     return v;
 }
 
-std::string applyStringConstraint(catena::Param &param, std::string v) {
+std::string applyStringConstraint(const catena::Device &device, catena::Param &param, std::string v) {
     /// @todo: add warning log for invalid constraint
     if (param.has_constraint()) {
         // apply the constraint
-        int constraint_type = param.constraint().type();
+        const catena::Constraint &constraint = resolveConstraint(device, param);
+        int constraint_type = constraint.type();
 
         switch (constraint_type) {
             case catena::Constraint_ConstraintType::Constraint_ConstraintType_STRING_CHOICE:
-                if (param.constraint().string_choice().strict()) {
-                    if (std::find_if(param.constraint().string_choice().choices().begin(),
-                                     param.constraint().string_choice().choices().end(),
+                if (constraint.string_choice().strict()) {
+                    if (std::find_if(constraint.string_choice().choices().begin(),
+                                     constraint.string_choice().choices().end(),
                                      [&](std::string const &c) { return c == v; }) ==
-                        param.constraint().string_choice().choices().end()) {
+                        constraint.string_choice().choices().end()) {
 
                         // if value is not in constraint, choose first item in list
-                        v = param.constraint().string_choice().choices(0);
+                        v = constraint.string_choice().choices(0);
                     }
                 }
                 break;
             case catena::Constraint_ConstraintType::Constraint_ConstraintType_STRING_STRING_CHOICE:
-                if (param.constraint().string_string_choice().strict()) {
-                    if (std::find_if(param.constraint().string_string_choice().choices().begin(),
-                                     param.constraint().string_string_choice().choices().end(),
+                if (constraint.string_string_choice().strict()) {
+                    if (std::find_if(constraint.string_string_choice().choices().begin(),
+                                     constraint.string_string_choice().choices().end(),
                                      [&](catena::StringStringChoiceConstraint_StringStringChoice const &c) {
                                          return c.value() == v;
-                                     }) == param.constraint().string_string_choice().choices().end()) {
+                                     }) == constraint.string_string_choice().choices().end()) {
                         // if value is not in constraint, choose first item in list
-                        v = param.constraint().string_string_choice().choices(0).value();
+                        v = constraint.string_string_choice().choices(0).value();
                     }
                 }
                 break;
@@ -277,173 +292,261 @@ std::string applyStringConstraint(catena::Param &param, std::string v) {
 }
 
 
-ParamAccessor::ParamAccessor(DeviceModel &dm, DeviceModel::ParamAccessorData &pad, const std::string& oid, const std::string& scope)
-    : deviceModel_{dm}, param_{*std::get<0>(pad)}, value_{*std::get<1>(pad)}, oid_{oid}, id_{std::hash<std::string>{}(oid)}, scope_{scope} {
-    static bool initialized = false;
-    if (!initialized) {
-        initialized = true;  // so we only do this once
+namespace {
 
-        // get our functories
-        auto &getter = Getter::getInstance();
-        auto &setter = Setter::getInstance();
-        auto &getterAt = GetterAt::getInstance();
-        auto &setterAt = SetterAt::getInstance();
-        auto &variantGetter = VariantInfoGetter::getInstance();
-        auto &valueGetter = ValueGetter::getInstance();
-        auto &valueSetter = ValueSetter::getInstance();
-        auto &valueGetterAt = ValueGetterAt::getInstance();
-        auto &valueSetterAt = ValueSetterAt::getInstance();
+/**
+ * @brief build the getters of values of simple types and arrays of them
+ */
+constexpr ParamAccessor::Getter makeGetter() {
+    ParamAccessor::Getter getter;
 
-        // register int getter
-        REGISTER_GETTER(KindCase::kInt32Value, int32_value, int32_t);
+    // register int getter
+    REGISTER_GETTER(KindCase::kInt32Value, int32_value, int32_t);
 
-        // register float getter
-        REGISTER_GETTER(KindCase::kFloat32Value, float32_value, float);
+    // register float getter
+    REGISTER_GETTER(KindCase::kFloat32Value, float32_value, float);
 
-        // register string getter
-        REGISTER_GETTER(KindCase::kStringValue, string_value, std::string);
+    // register string getter
+    REGISTER_GETTER(KindCase::kStringValue, string_value, std::string);
 
-        // register int32 setter
-        REGISTER_SETTER(KindCase::kInt32Value, set_int32_value, int32_t);
+    // register array of int getter
+    REGISTER_ARRAY_GETTER(KindCase::kInt32ArrayValues, int32_t, int32_array_values, ints);
 
-        // register float32 setter
-        REGISTER_SETTER(KindCase::kFloat32Value, set_float32_value, float);
+    // register array of float getter
+    REGISTER_ARRAY_GETTER(KindCase::kFloat32ArrayValues, float, float32_array_values, floats);
 
-        // register string setter
-        REGISTER_SETTER(KindCase::kStringValue, set_string_value, std::string);
+    // register array of string getter
+    REGISTER_ARRAY_GETTER(KindCase::kStringArrayValues, std::string, string_array_values, strings);
 
-        // register array of int getter
-        REGISTER_ARRAY_GETTER(KindCase::kInt32ArrayValues, int32_t, int32_array_values, ints);
+    return getter;
+}
 
-        // register array of float getter
-        REGISTER_ARRAY_GETTER(KindCase::kFloat32ArrayValues, float, float32_array_values, floats);
+/**
+ * @brief build the setters of values of simple types and arrays of them
+ */
+constexpr ParamAccessor::Setter makeSetter() {
+    ParamAccessor::Setter setter;
 
-        // register array of string getter
-        REGISTER_ARRAY_GETTER(KindCase::kStringArrayValues, std::string, string_array_values, strings);
+    // register int32 setter
+    REGISTER_SETTER(KindCase::kInt32Value, set_int32_value, int32_t);
 
-        // register array of int setter
-        REGISTER_ARRAY_SETTER(KindCase::kInt32ArrayValues, mutable_int32_array_values, clear_ints, int32_t, add_ints);
+    // register float32 setter
+    REGISTER_SETTER(KindCase::kFloat32Value, set_float32_value, float);
 
-        //register array of float setter
-        REGISTER_ARRAY_SETTER(KindCase::kFloat32ArrayValues, mutable_float32_array_values, clear_floats, float, add_floats);
+    // register string setter
+    REGISTER_SETTER(KindCase::kStringValue, set_string_value, std::string);
 
-        //register array of string setter
-        REGISTER_ARRAY_SETTER(KindCase::kStringArrayValues, mutable_string_array_values, clear_strings, std::string, add_strings);
-    
-        // register element of array of int getter
-        REGISTER_ARRAY_GETTER_AT(KindCase::kInt32ArrayValues, int32_t, int32_array_values, ints_size, ints);
+    // register array of int setter
+    REGISTER_ARRAY_SETTER(KindCase::kInt32ArrayValues, mutable_int32_array_values, clear_ints, int32_t, add_ints);
 
-        // register element of array of float getter
-        REGISTER_ARRAY_GETTER_AT(KindCase::kFloat32ArrayValues, float, float32_array_values, floats_size, floats);
+    //register array of float setter
+    REGISTER_ARRAY_SETTER(KindCase::kFloat32ArrayValues, mutable_float32_array_values, clear_floats, float, add_floats);
 
-        // register element of array of string getter
-        REGISTER_ARRAY_GETTER_AT(KindCase::kStringArrayValues, std::string, string_array_values, strings_size, strings);
+    //register array of string setter
+    REGISTER_ARRAY_SETTER(KindCase::kStringArrayValues, mutable_string_array_values, clear_strings, std::string, add_strings);
 
-        // register element of array of int setter
-        REGISTER_ARRAY_SETTER_AT(KindCase::kInt32ArrayValues, int32_t, mutable_int32_array_values, ints_size, set_ints);
+    return setter;
+}
 
-        // register element of array of float setter
-        REGISTER_ARRAY_SETTER_AT(KindCase::kFloat32ArrayValues, float, mutable_float32_array_values, floats_size, set_floats);
+/**
+ * @brief build the getters of elements of arrays of simple types
+ */
+constexpr ParamAccessor::GetterAt makeGetterAt() {
+    ParamAccessor::GetterAt getterAt;
 
-        // register element of array of string setter
-        REGISTER_ARRAY_SETTER_AT(KindCase::kStringArrayValues, std::string, mutable_string_array_values, strings_size, set_strings);
-        
-        
-        /** Register Value Getters/Setters */
+    // register element of array of int getter
+    REGISTER_ARRAY_GETTER_AT(KindCase::kInt32ArrayValues, int32_t, int32_array_values, ints_size, ints);
 
+    // register element of array of float getter
+    REGISTER_ARRAY_GETTER_AT(KindCase::kFloat32ArrayValues, float, float32_array_values, floats_size, floats);
 
-        //register value getter for int32
-        REGISTER_VALUE_GETTER(KindCase::kInt32Value);
+    // register element of array of string getter
+    REGISTER_ARRAY_GETTER_AT(KindCase::kStringArrayValues, std::string, string_array_values, strings_size, strings);
 
-        //register value getter for float32
-        REGISTER_VALUE_GETTER(KindCase::kFloat32Value);
+    return getterAt;
+}
 
-        //register value getter for string
-        REGISTER_VALUE_GETTER(KindCase::kStringValue);
+/**
+ * @brief build the setters of elements of arrays of simple types
+ */
+constexpr ParamAccessor::SetterAt makeSetterAt() {
+    ParamAccessor::SetterAt setterAt;
 
-        //register value getter for struct
-        REGISTER_VALUE_GETTER(KindCase::kStructValue);
+    // register element of array of int setter
+    REGISTER_ARRAY_SETTER_AT(KindCase::kInt32ArrayValues, int32_t, mutable_int32_array_values, ints_size, set_ints);
 
-        // register value setter for int32
-        REGISTER_VALUE_SETTER(KindCase::kInt32Value, set_int32_value, int32_value);
+    // register element of array of float setter
+    REGISTER_ARRAY_SETTER_AT(KindCase::kFloat32ArrayValues, float, mutable_float32_array_values, floats_size, set_floats);
 
-        // register value setter for float32
-        REGISTER_VALUE_SETTER(KindCase::kFloat32Value, set_float32_value, float32_value);
+    // register element of array of string setter
+    REGISTER_ARRAY_SETTER_AT(KindCase::kStringArrayValues, std::string, mutable_string_array_values, strings_size, set_strings);
 
-        // register value setter for string
-        REGISTER_VALUE_SETTER(KindCase::kStringValue, set_string_value, string_value);
+    return setterAt;
+}
 
-        // register value getter for int32 array
-        REGISTER_ARRAY_VALUE_GETTER(KindCase::kInt32ArrayValues);
+/**
+ * @brief build the getters of values for clients
+ */
+constexpr ParamAccessor::ValueGetter makeValueGetter() {
+    ParamAccessor::ValueGetter valueGetter;
 
-        // register value getter for float32 array
-        REGISTER_ARRAY_VALUE_GETTER(KindCase::kFloat32ArrayValues);
+    //register value getter for int32
+    REGISTER_VALUE_GETTER(KindCase::kInt32Value);
 
-        // register value getter for string array
-        REGISTER_ARRAY_VALUE_GETTER(KindCase::kStringArrayValues);
+    //register value getter for float32
+    REGISTER_VALUE_GETTER(KindCase::kFloat32Value);
 
-        // register value getter for struct array
-        REGISTER_ARRAY_VALUE_GETTER(KindCase::kStructArrayValues);
+    //register value getter for string
+    REGISTER_VALUE_GETTER(KindCase::kStringValue);
 
-        // register value setter for int32 array
-        REGISTER_ARRAY_VALUE_SETTER(KindCase::kInt32ArrayValues);
+    //register value getter for struct
+    REGISTER_VALUE_GETTER(KindCase::kStructValue);
 
-        // register value setter for float32 array
-        REGISTER_ARRAY_VALUE_SETTER(KindCase::kFloat32ArrayValues);
+    // register value getter for int32 array
+    REGISTER_ARRAY_VALUE_GETTER(KindCase::kInt32ArrayValues);
 
-        // register value setter for string array
-        REGISTER_ARRAY_VALUE_SETTER(KindCase::kStringArrayValues);
+    // register value getter for float32 array
+    REGISTER_ARRAY_VALUE_GETTER(KindCase::kFloat32ArrayValues);
 
-        // register value setter for struct array
-        REGISTER_ARRAY_VALUE_SETTER(KindCase::kStructArrayValues);
+    // register value getter for string array
+    REGISTER_ARRAY_VALUE_GETTER(KindCase::kStringArrayValues);
 
-        // register value setter for variant array
-        REGISTER_ARRAY_VALUE_SETTER(KindCase::kStructVariantArrayValues);
+    // register value getter for struct array
+    REGISTER_ARRAY_VALUE_GETTER(KindCase::kStructArrayValues);
 
-        // register value getter for element of int32 array
-        REGISTER_ARRAY_VALUE_GETTER_AT(KindCase::kInt32ArrayValues, int32_array_values, ints_size, set_int32_value, ints);
+    return valueGetter;
+}
 
-        // register value getter for element of float array
-        REGISTER_ARRAY_VALUE_GETTER_AT(KindCase::kFloat32ArrayValues, float32_array_values, floats_size, set_float32_value, floats);
+/**
+ * @brief build the setters of values from clients
+ */
+constexpr ParamAccessor::ValueSetter makeValueSetter() {
+    ParamAccessor::ValueSetter valueSetter;
 
-        // register value getter for element of string array
-        REGISTER_ARRAY_VALUE_GETTER_AT(KindCase::kStringArrayValues, string_array_values, strings_size, set_string_value, strings);
+    // register value setter for int32
+    REGISTER_VALUE_SETTER(KindCase::kInt32Value, set_int32_value, int32_value);
 
-        // register value getter for element of struct array
-        valueGetterAt.addFunction(KindCase::kStructArrayValues, [](Value* dst, const Value &val, ParamIndex idx) -> void {
-            auto size = val.struct_array_values().struct_values_size();
-            if (idx >= size) {
-                std::stringstream err;
-                err << "array index is out of bounds, " << idx
-                    << " >= " << size;
-                BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
-            }
-            *dst->mutable_struct_value() = val.struct_array_values().struct_values(idx);
-        });
+    // register value setter for float32
+    REGISTER_VALUE_SETTER(KindCase::kFloat32Value, set_float32_value, float32_value);
 
-        // register value getter for element of variant array
-        valueGetterAt.addFunction(KindCase::kStructVariantArrayValues, [](Value* dst, const Value &val, ParamIndex idx) -> void {
-            auto size = val.struct_variant_array_values().struct_variants_size();
-            if (idx >= size) {
-                std::stringstream err;
-                err << "array index is out of bounds, " << idx
-                    << " >= " << size;
-                BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
-            }
-            *dst->mutable_struct_variant_value() = val.struct_variant_array_values().struct_variants(idx);
-        });
-        
-        // register value setter for element of int32 array
-        REGISTER_ARRAY_VALUE_SETTER_AT(KindCase::kInt32ArrayValues, int32_array_values, ints_size, mutable_int32_array_values, mutable_ints, int32_value);     
+    // register value setter for string
+    REGISTER_VALUE_SETTER(KindCase::kStringValue, set_string_value, string_value);
 
-        // register value setter for element of float array
-        REGISTER_ARRAY_VALUE_SETTER_AT(KindCase::kFloat32ArrayValues, float32_array_values, floats_size, mutable_float32_array_values, mutable_floats, float32_value); 
+    // register value setter for int32 array
+    REGISTER_ARRAY_VALUE_SETTER(KindCase::kInt32ArrayValues);
 
-        // register value setter for element of string array
-        REGISTER_ARRAY_VALUE_SETTER_AT(KindCase::kStringArrayValues, string_array_values, strings_size, mutable_string_array_values, mutable_strings, string_value);  
-    }
+    // register value setter for float32 array
+    REGISTER_ARRAY_VALUE_SETTER(KindCase::kFloat32ArrayValues);
+
+    // register value setter for string array
+    REGISTER_ARRAY_VALUE_SETTER(KindCase::kStringArrayValues);
+
+    // register value setter for struct array
+    REGISTER_ARRAY_VALUE_SETTER(KindCase::kStructArrayValues);
+
+    // register value setter for variant array
+    REGISTER_ARRAY_VALUE_SETTER(KindCase::kStructVariantArrayValues);
+
+    return valueSetter;
 }
 
+/**
+ * @brief build the getters of array elements for clients
+ */
+constexpr ParamAccessor::ValueGetterAt makeValueGetterAt() {
+    ParamAccessor::ValueGetterAt valueGetterAt;
+
+    // register value getter for element of int32 array
+    REGISTER_ARRAY_VALUE_GETTER_AT(KindCase::kInt32ArrayValues, int32_array_values, ints_size, set_int32_value, ints);
+
+    // register value getter for element of float array
+    REGISTER_ARRAY_VALUE_GETTER_AT(KindCase::kFloat32ArrayValues, float32_array_values, floats_size, set_float32_value, floats);
+
+    // register value getter for element of string array
+    REGISTER_ARRAY_VALUE_GETTER_AT(KindCase::kStringArrayValues, string_array_values, strings_size, set_string_value, strings);
+
+    // register value getter for element of struct array
+    valueGetterAt.addFunction(KindCase::kStructArrayValues, [](Value* dst, const Value &val, ParamIndex idx) -> void {
+        const std::size_t size = val.struct_array_values().struct_values_size();
+        if (idx >= size) {
+            std::stringstream err;
+            err << "array index is out of bounds, " << idx
+                << " >= " << size;
+            BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
+        }
+        *dst->mutable_struct_value() = val.struct_array_values().struct_values(idx);
+    });
+
+    // register value getter for element of variant array
+    valueGetterAt.addFunction(KindCase::kStructVariantArrayValues, [](Value* dst, const Value &val, ParamIndex idx) -> void {
+        const std::size_t size = val.struct_variant_array_values().struct_variants_size();
+        if (idx >= size) {
+            std::stringstream err;
+            err << "array index is out of bounds, " << idx
+                << " >= " << size;
+            BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
+        }
+        *dst->mutable_struct_variant_value() = val.struct_variant_array_values().struct_variants(idx);
+    });
+
+    return valueGetterAt;
+}
+
+/**
+ * @brief build the setters of array elements from clients
+ */
+constexpr ParamAccessor::ValueSetterAt makeValueSetterAt() {
+    ParamAccessor::ValueSetterAt valueSetterAt;
+
+    // register value setter for element of int32 array
+    REGISTER_ARRAY_VALUE_SETTER_AT(KindCase::kInt32ArrayValues, int32_array_values, ints_size, mutable_int32_array_values, mutable_ints, int32_value);
+
+    // register value setter for element of float array
+    REGISTER_ARRAY_VALUE_SETTER_AT(KindCase::kFloat32ArrayValues, float32_array_values, floats_size, mutable_float32_array_values, mutable_floats, float32_value);
+
+    // register value setter for element of string array
+    REGISTER_ARRAY_VALUE_SETTER_AT(KindCase::kStringArrayValues, string_array_values, strings_size, mutable_string_array_values, mutable_strings, string_value);
+
+    // register value setter for element of struct array
+    valueSetterAt.addFunction(KindCase::kStructArrayValues, [](Value &dst, const Value &src, ParamIndex idx) -> void {
+        const std::size_t size = dst.struct_array_values().struct_values_size();
+        if (idx >= size) {
+            std::stringstream err;
+            err << "array index is out of bounds, " << idx
+                << " >= " << size;
+            BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
+        }
+        *dst.mutable_struct_array_values()->mutable_struct_values(idx) = src.struct_value();
+    });
+
+    // register value setter for element of variant array
+    valueSetterAt.addFunction(KindCase::kStructVariantArrayValues, [](Value &dst, const Value &src, ParamIndex idx) -> void {
+        const std::size_t size = dst.struct_variant_array_values().struct_variants_size();
+        if (idx >= size) {
+            std::stringstream err;
+            err << "array index is out of bounds, " << idx
+                << " >= " << size;
+            BAD_STATUS(err.str(), catena::StatusCode::OUT_OF_RANGE);
+        }
+        *dst.mutable_struct_variant_array_values()->mutable_struct_variants(idx) = src.struct_variant_value();
+    });
+
+    return valueSetterAt;
+}
+
+}  // namespace
+
+constinit const ParamAccessor::Getter ParamAccessor::getter_ = makeGetter();
+constinit const ParamAccessor::Setter ParamAccessor::setter_ = makeSetter();
+constinit const ParamAccessor::GetterAt ParamAccessor::getterAt_ = makeGetterAt();
+constinit const ParamAccessor::SetterAt ParamAccessor::setterAt_ = makeSetterAt();
+constinit const ParamAccessor::ValueGetter ParamAccessor::valueGetter_ = makeValueGetter();
+constinit const ParamAccessor::ValueSetter ParamAccessor::valueSetter_ = makeValueSetter();
+constinit const ParamAccessor::ValueGetterAt ParamAccessor::valueGetterAt_ = makeValueGetterAt();
+constinit const ParamAccessor::ValueSetterAt ParamAccessor::valueSetterAt_ = makeValueSetterAt();
+
+ParamAccessor::ParamAccessor(DeviceModel &dm, DeviceModel::ParamAccessorData &pad, const std::string& oid, const std::string& scope, ParamIndex index)
+    : deviceModel_{dm}, param_{*std::get<0>(pad)}, value_{*std::get<1>(pad)}, oid_{oid}, id_{std::hash<std::string>{}(oid)}, scope_{scope}, index_{index} {}
 
 template <> catena::Value::KindCase catena::full::getKindCase<int32_t>(const int32_t & src) {
     return catena::Value::KindCase::kInt32Value;
@@ -476,14 +579,68 @@ template <typename V> catena::Value::KindCase getKindCase(const V& src) {
     return catena::Value::KindCase::KIND_NOT_SET;
 }
 
-void ParamAccessor::setValue(const std::string& peer, const Value &src) {
+/**
+ * @brief does replacing the value destroy values that sub-params, or
+ * elements of arrays, can be accessed by
+ */
+static bool hasSubValues(const Value &value) {
+    switch (value.kind_case()) {
+        case catena::Value::KindCase::kStructValue:
+        case catena::Value::KindCase::kStructVariantValue:
+        case catena::Value::KindCase::kStructArrayValues:
+        case catena::Value::KindCase::kStructVariantArrayValues:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief src, or a copy of it with the param's constraint applied if it's an
+ * int32 or string param with a constraint
+ *
+ * @param device the device, whose shared constraints param may refer to
+ * @param param the param being set
+ * @param src the value from the client
+ * @param constrained [out] storage for the constrained copy
+ * @return the value to write
+ */
+static const Value &applyConstraint(const catena::Device &device, catena::Param &param, const Value &src,
+                                    Value &constrained) {
+    if (!param.has_constraint()) {
+        return src;
+    }
+    if (param.type() == catena::ParamType::INT32 && src.kind_case() == KindCase::kInt32Value) {
+        constrained.set_int32_value(applyIntConstraint(device, param, src.int32_value()));
+        return constrained;
+    }
+    if (param.type() == catena::ParamType::STRING && src.kind_case() == KindCase::kStringValue) {
+        constrained.set_string_value(applyStringConstraint(device, param, src.string_value()));
+        return constrained;
+    }
+    return src;
+}
+
+void ParamAccessor::setValue(const std::string& peer, const Value &rawSrc) {
     std::lock_guard<DeviceModel::Mutex> lock(deviceModel_.get().mutex_);
     try {
+        Value constrained;
+        const Value &src = applyConstraint(deviceModel_.get().device(), param_.get(), rawSrc, constrained);
         Value &value = value_.get();
-        auto& setter = ValueSetter::getInstance();
-        setter[value.kind_case()](value, src);
-        deviceModel_.get().valueSetByClient.emit(*this, -1, peer);
-        deviceModel_.get().pushUpdates.emit(*this, -1);
+        if (hasSubValues(value)) {
+            // the sub-values are about to be destroyed
+            deviceModel_.get().subValuesReplaced_();
+        }
+        if (index_ != kParamEnd) {
+            // only the element the accessor is to
+            valueSetterAt_[value.kind_case()](value, src, index_);
+        } else {
+            valueSetter_[value.kind_case()](value, src);
+        }
+        emitChange_(index_, [this, &peer](const ParamAccessor& p, ParamIndex i) {
+            deviceModel_.get().valueSetByClient.emit(p, i, peer);
+            deviceModel_.get().pushUpdates.emit(p, i);
+        });
     } catch (const catena::exception_with_status& why) {
         std::stringstream err;
         err << "setValue failed: " << why.what() << '\n' << __PRETTY_FUNCTION__ << '\n';
@@ -492,7 +649,7 @@ void ParamAccessor::setValue(const std::string& peer, const Value &src) {
         throw catena::exception_with_status(__PRETTY_FUNCTION__, catena::StatusCode::UNKNOWN);
     }
 }
-void ParamAccessor::setValue(const std::string& peer, const Value &src, ParamIndex idx, std::vector<std::string>& clientScopes) {
+void ParamAccessor::setValue(const std::string& peer, const Value &rawSrc, ParamIndex idx, std::vector<std::string>& clientScopes) {
     std::lock_guard<DeviceModel::Mutex> lock(deviceModel_.get().mutex_);
     try {  
         if (clientScopes[0] != kAuthzDisabled) {
@@ -500,21 +657,31 @@ void ParamAccessor::setValue(const std::string& peer, const Value &src, ParamInd
                 BAD_STATUS("Not authorized to access this parameter", catena::StatusCode::PERMISSION_DENIED);
             }
         }
+        if (index_ != kParamEnd) {
+            idx = index_;
+        }
+        Value constrained;
+        const Value &src = applyConstraint(deviceModel_.get().device(), param_.get(), rawSrc, constrained);
         Value &value = value_.get();
         if (!sameKind(src, idx)) {
             BAD_STATUS("Value type mismatch", catena::StatusCode::INVALID_ARGUMENT);
         }
         
+        if (hasSubValues(value)) {
+            // the sub-values are about to be destroyed
+            deviceModel_.get().subValuesReplaced_();
+        }
         if (isList() && idx != kParamEnd) {
             // update array element
-            auto& setterAt = ValueSetterAt::getInstance();
-            setterAt[value.kind_case()](value, src, idx);
+            valueSetterAt_[value.kind_case()](value, src, idx);
         } else {
             // update scalar value or whole array
             value.CopyFrom(src);
         }
-        deviceModel_.get().valueSetByClient.emit(*this, idx, peer);
-        deviceModel_.get().pushUpdates.emit(*this, idx);
+        emitChange_(idx, [this, &peer](const ParamAccessor& p, ParamIndex i) {
+            deviceModel_.get().valueSetByClient.emit(p, i, peer);
+            deviceModel_.get().pushUpdates.emit(p, i);
+        });
     } catch (const catena::exception_with_status& why) {
         std::stringstream err;
         err << "setValue failed: " << why.what() << '\n' << __PRETTY_FUNCTION__ << '\n';
@@ -524,40 +691,60 @@ void ParamAccessor::setValue(const std::string& peer, const Value &src, ParamInd
     }
 }
 
-void ParamAccessor::getParam_(DeviceModel::const_ParamAccessorData &src, DeviceModel::ParamAccessorData &dst, 
-            const std::string& parentScope, const std::vector<std::string>& clientScopes) const {
-    
-    // copy to get basic param info
-    *std::get<0>(dst) = *std::get<0>(src);
-    
-    if (std::get<0>(src)->type() == catena::ParamType::STRUCT) {
-        // clear sub-params and their values because their scope needs to be checked
-        std::get<0>(dst)->clear_params();
-        std::get<1>(dst)->Clear();
-
-        for (auto &it : std::get<0>(src)->params()) {
-            const std::string& scope = it.second.access_scope() == "" ? parentScope : it.second.access_scope();
-
-            if (checkScope(clientScopes, scope)) {
-                const catena::Param* srcSubParam = &it.second;
-                const catena::Value* srcSubValue = &std::get<1>(src)->struct_value().fields().at(it.first).value();
-                DeviceModel::const_ParamAccessorData subSrc = {srcSubParam, srcSubValue};
-                
-                // add a new param field to the dst struct
-                auto newSubParam = std::get<0>(dst)->mutable_params()->insert({it.first, catena::Param{}});
-                catena::Param* dstSubParam = &newSubParam.first->second;
-                // add a new value field to the dst struct
-                auto newSubValue = std::get<1>(dst)->mutable_struct_value()->mutable_fields()->insert({it.first, catena::StructField{}});
-                catena::Value* dstSubValue = newSubValue.first->second.mutable_value();
-                DeviceModel::ParamAccessorData subDst = {dstSubParam, dstSubValue};
-
-                getParam_(subSrc, subDst, scope, clientScopes);
-            }
+/**
+ * @brief copy everything about a param but its value and sub-params
+ *
+ * Keep in step with the fields of Param in param.proto.
+ */
+static void copyDescriptor(const catena::Param &src, catena::Param &dst) {
+    if (src.has_name()) {
+        *dst.mutable_name() = src.name();
+    }
+    dst.set_type(src.type());
+    dst.set_read_only(src.read_only());
+    dst.set_widget(src.widget());
+    dst.set_precision(src.precision());
+    if (src.has_constraint()) {
+        *dst.mutable_constraint() = src.constraint();
+    }
+    dst.set_max_length(src.max_length());
+    dst.set_total_length(src.total_length());
+    dst.set_access_scope(src.access_scope());
+    *dst.mutable_client_hints() = src.client_hints();
+    *dst.mutable_commands() = src.commands();
+    dst.set_response(src.response());
+    if (src.has_help()) {
+        *dst.mutable_help() = src.help();
+    }
+    if (src.has_import()) {
+        *dst.mutable_import() = src.import();
+    }
+    *dst.mutable_oid_aliases() = src.oid_aliases();
+    dst.set_minimal_set(src.minimal_set());
+    dst.set_stateless(src.stateless());
+    dst.set_template_oid(src.template_oid());
+}
+
+void ParamAccessor::getParam_(const catena::Param &src, const catena::Value &srcValue, catena::Param &dst,
+                              catena::Value &dstValue, const std::string &scope,
+                              const std::vector<std::string> &clientScopes) {
+    copyDescriptor(src, dst);
+
+    if (src.type() != catena::ParamType::STRUCT) {
+        dstValue = srcValue;
+        return;
+    }
+
+    // only the sub-params, and fields of the value, in the client's scopes
+    const auto &srcFields = srcValue.struct_value().fields();
+    auto &dstFields = *dstValue.mutable_struct_value()->mutable_fields();
+    for (const auto &[oid, srcSubParam] : src.params()) {
+        const std::string &subScope = srcSubParam.access_scope() == "" ? scope : srcSubParam.access_scope();
+        if (!checkScope(clientScopes, subScope)) {
+            continue;
         }
-        
-    } else {
-        // copy value
-        *std::get<1>(dst) = *std::get<1>(src);
+        getParam_(srcSubParam, srcFields.at(oid).value(), (*dst.mutable_params())[oid],
+                  *dstFields[oid].mutable_value(), subScope, clientScopes);
     }
 }
 
@@ -569,9 +756,8 @@ void ParamAccessor::getParam(catena::DeviceComponent_ComponentParam *dst, std::v
         BAD_STATUS("Not authorized to access this parameter", catena::StatusCode::PERMISSION_DENIED);
     }
 
-    DeviceModel::const_ParamAccessorData srcData = {&param_.get(), &value_.get()};
-    DeviceModel::ParamAccessorData dstData = {param, param->mutable_value()};
-    getParam_(srcData, dstData, scope_, clientScopes);
+    std::shared_lock<DeviceModel::Mutex> lock(deviceModel_.get().mutex_);
+    getParam_(param_.get(), value_.get(), *param, *param->mutable_value(), scope_, clientScopes);
 
     // needed to make param aware that it's value has changed
     param->mutable_value(); 
@@ -586,7 +772,7 @@ bool ParamAccessor::checkScope(const std::vector<std::string>& clientScopes) con
     return true;
 }
 
-bool ParamAccessor::checkScope(const std::vector<std::string>& clientScopes, const std::string& paramScope) const {
+bool ParamAccessor::checkScope(const std::vector<std::string>& clientScopes, const std::string& paramScope) {
     if (clientScopes[0] != kAuthzDisabled) {
         if (std::find(clientScopes.begin(), clientScopes.end(), paramScope) == clientScopes.end()) {
             return false;
@@ -606,6 +792,10 @@ bool ParamAccessor::sameKind(const Value &src, const ParamIndex idx) const {
                 return src.kind_case() == catena::Value::KindCase::kFloat32Value;
             case catena::Value::KindCase::kStringArrayValues:
                 return src.kind_case() == catena::Value::KindCase::kStringValue;
+            case catena::Value::KindCase::kStructArrayValues:
+                return src.kind_case() == catena::Value::KindCase::kStructValue;
+            case catena::Value::KindCase::kStructVariantArrayValues:
+                return src.kind_case() == catena::Value::KindCase::kStructVariantValue;
             default:
                 return false;
         }
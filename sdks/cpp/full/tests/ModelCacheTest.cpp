@@ -0,0 +1,217 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include <full/include/ModelCache.h>
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using catena::full::ModelCache;
+
+class ModelCacheTest : public ::testing::Test {
+  protected:
+    /**
+     * @brief a scratch directory for the current test
+     */
+    static std::filesystem::path testDir() {
+        const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        return std::filesystem::temp_directory_path() / (std::string("catena_model_cache_") + info->name());
+    }
+
+    void SetUp() override {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        source = dir / "device.json";
+        writeFile(source, R"({"slot": 1})");
+
+        device.set_slot(1);
+        device.set_default_scope("monitor");
+        catena::Param& param = (*device.mutable_params())["count"];
+        param.set_type(catena::ParamType::INT32);
+        param.mutable_value()->set_int32_value(7);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    static void writeFile(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file << content;
+    }
+
+    static std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    /**
+     * @brief cache the device, as read from source
+     */
+    void save() {
+        std::vector<ModelCache::Source> sources(1);
+        ModelCache::readSource(source, sources.front());
+        cache.save(device, sources);
+    }
+
+    /**
+     * @brief move a file's modification time on, as an edit would
+     */
+    static void touch(const std::filesystem::path& path) {
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(2));
+    }
+
+    std::filesystem::path dir{testDir()};
+    std::filesystem::path source;
+    catena::Device device;
+    ModelCache cache{dir / "device.cache"};
+};
+
+TEST_F(ModelCacheTest, LoadsWhatWasSaved) {
+    save();
+    catena::Device loaded;
+    ASSERT_TRUE(cache.load(source, loaded));
+    EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(loaded, device));
+}
+
+TEST_F(ModelCacheTest, TouchedButUnchangedIsValid) {
+    save();
+    touch(source);
+    catena::Device loaded;
+    EXPECT_TRUE(cache.load(source, loaded));
+}
+
+TEST_F(ModelCacheTest, EditedSourceIsStale) {
+    save();
+    catena::Device loaded;
+
+    // same size, different content
+    writeFile(source, R"({"slot": 2})");
+    touch(source);
+    EXPECT_FALSE(cache.load(source, loaded));
+
+    // different size
+    save();
+    writeFile(source, R"({"slot": 12})");
+    EXPECT_FALSE(cache.load(source, loaded));
+
+    // removed
+    save();
+    std::filesystem::remove(source);
+    EXPECT_FALSE(cache.load(source, loaded));
+}
+
+TEST_F(ModelCacheTest, OtherModelIsStale) {
+    save();
+    std::filesystem::path other = dir / "other.json";
+    writeFile(other, readFile(source));
+    catena::Device loaded;
+    EXPECT_FALSE(cache.load(other, loaded));
+}
+
+TEST_F(ModelCacheTest, PartialWriteIsInvalid) {
+    save();
+    std::filesystem::path cached = dir / "device.cache";
+    std::string serialized = readFile(cached);
+    catena::Device loaded;
+
+    // interrupted before the manifest was written
+    std::filesystem::remove(cache.manifest());
+    EXPECT_FALSE(cache.load(source, loaded));
+
+    // the device cut short
+    save();
+    writeFile(cached, serialized.substr(0, serialized.size() / 2));
+    EXPECT_FALSE(cache.load(source, loaded));
+
+    // the manifest cut short
+    save();
+    std::string manifest = readFile(cache.manifest());
+    writeFile(cache.manifest(), manifest.substr(0, manifest.find('\n') + 1));
+    EXPECT_FALSE(cache.load(source, loaded));
+}
+
+TEST_F(ModelCacheTest, CorruptDeviceIsInvalid) {
+    save();
+    std::filesystem::path cached = dir / "device.cache";
+    std::string serialized = readFile(cached);
+    ASSERT_FALSE(serialized.empty());
+    // the same size, so only its hash tells it apart
+    serialized.back() ^= 1;
+    writeFile(cached, serialized);
+    catena::Device loaded;
+    EXPECT_FALSE(cache.load(source, loaded));
+}
+
+TEST_F(ModelCacheTest, ConcurrentSavesDontMix) {
+    catena::Device other = device;
+    other.set_slot(2);
+    (*other.mutable_params())["count"].mutable_value()->set_int32_value(8);
+
+    std::vector<ModelCache::Source> sources(1);
+    ModelCache::readSource(source, sources.front());
+    auto saveRepeatedly = [this, &sources](const catena::Device& d) {
+        for (int i = 0; i < 50; ++i) {
+            cache.save(d, sources);
+        }
+    };
+    std::thread a(saveRepeatedly, std::cref(device));
+    std::thread b(saveRepeatedly, std::cref(other));
+    a.join();
+    b.join();
+
+    // whichever save finished last, the cache is one of them, or invalid
+    catena::Device loaded;
+    if (cache.load(source, loaded)) {
+        EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(loaded, device) ||
+                    google::protobuf::util::MessageDifferencer::Equals(loaded, other));
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        EXPECT_NE(entry.path().extension(), ".tmp") << entry.path();
+    }
+}
+
+TEST_F(ModelCacheTest, OtherSchemaIsStale) {
+    save();
+    std::string manifest = readFile(cache.manifest());
+    std::size_t eol = manifest.find('\n');
+    ASSERT_NE(eol, std::string::npos);
+    // a different schema hash
+    char& last = manifest[eol - 1];
+    last = last == '0' ? '1' : '0';
+    writeFile(cache.manifest(), manifest);
+    catena::Device loaded;
+    EXPECT_FALSE(cache.load(source, loaded));
+}
+
+TEST_F(ModelCacheTest, OversizedDeviceIsInvalid) {
+    save();
+    std::string manifest = readFile(cache.manifest());
+    std::size_t start = manifest.find('\n') + 1;
+    std::size_t end = manifest.find(' ', start);
+    // a size that ParseFromArray's int would truncate, keeping the hash
+    manifest.replace(start, end - start, "2147483648");
+    writeFile(cache.manifest(), manifest);
+    catena::Device loaded;
+    EXPECT_FALSE(cache.load(source, loaded));
+}
@@ -0,0 +1,213 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include <full/include/DeviceModel.h>
+#include <full/include/ParamAccessor.h>
+#include <full/include/TypeTraits.h>
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using catena::full::DeviceModel;
+using catena::full::kAuthzDisabled;
+using catena::full::kParamEnd;
+using catena::full::ParamAccessor;
+using catena::full::ParamIndex;
+
+namespace {
+
+const char* kModel = R"({
+  "slot": 1,
+  "access_scopes": ["monitor", "operate"],
+  "default_scope": "operate",
+  "params": {
+    "primes": {
+      "type": "INT32_ARRAY",
+      "value": { "int32_array_values": { "ints": [2, 3, 5, 7] } }
+    },
+    "gain_tmpl": {
+      "type": "INT32",
+      "value": { "int32_value": 0 },
+      "constraint": { "type": "INT_RANGE", "int32_range": { "min_value": 0, "max_value": 10 } }
+    },
+    "gain": { "template_oid": "/gain_tmpl", "value": { "int32_value": 5 } },
+    "mode_tmpl": {
+      "type": "STRING",
+      "value": { "string_value": "auto" },
+      "constraint": { "type": "STRING_CHOICE", "string_choice": { "choices": ["auto", "manual"], "strict": true } }
+    },
+    "mode": { "template_oid": "/mode_tmpl" },
+    "strip": {
+      "type": "STRUCT",
+      "params": { "gain": { "type": "INT32" }, "pan": { "type": "INT32" } },
+      "value": { "struct_value": { "fields": {
+        "gain": { "value": { "int32_value": 1 } },
+        "pan": { "value": { "int32_value": 2 } }
+      } } }
+    }
+  }
+})";
+
+/**
+ * @brief set a native int32 field through its sub-param's accessor
+ */
+void setInt32Field(ParamAccessor* pa, const void* src) { pa->setValue<false>(*static_cast<const int32_t*>(src)); }
+
+/**
+ * @brief a native struct matching "/strip"
+ */
+struct Strip {
+    int32_t gain;
+    int32_t pan;
+
+    static const catena::full::StructInfo& getStructInfo() {
+        static const catena::full::StructInfo info = [] {
+            catena::full::StructInfo ans;
+            ans.name = "Strip";
+            ans.fields.push_back({"gain", offsetof(Strip, gain), {}, {}, setInt32Field});
+            ans.fields.push_back({"pan", offsetof(Strip, pan), {}, {}, setInt32Field});
+            return ans;
+        }();
+        return info;
+    }
+};
+
+/**
+ * @brief like Strip, with a field "/strip" doesn't have, after one it does
+ */
+struct BadStrip {
+    int32_t gain;
+    int32_t width;
+
+    static const catena::full::StructInfo& getStructInfo() {
+        static const catena::full::StructInfo info = [] {
+            catena::full::StructInfo ans;
+            ans.name = "BadStrip";
+            ans.fields.push_back({"gain", offsetof(BadStrip, gain), {}, {}, setInt32Field});
+            ans.fields.push_back({"width", offsetof(BadStrip, width), {}, {}, setInt32Field});
+            return ans;
+        }();
+        return info;
+    }
+};
+
+}  // namespace
+
+class SetValueTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = std::filesystem::temp_directory_path() / (std::string("catena_set_value_") + info->name() + ".json");
+        std::ofstream(path) << kModel;
+        dm = std::make_unique<DeviceModel>(path.string());
+        pushId = dm->pushUpdates.connect([this](const ParamAccessor& p, ParamIndex idx) {
+            pushed.emplace_back(p.oid(), idx);
+        });
+    }
+
+    void TearDown() override {
+        dm->pushUpdates.disconnect(pushId);
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+    std::unique_ptr<DeviceModel> dm;
+    unsigned int pushId{0};
+    std::vector<std::pair<std::string, ParamIndex>> pushed;
+};
+
+TEST_F(SetValueTest, ElementPushIsTheArraysOidAndIndex) {
+    using Push = std::pair<std::string, ParamIndex>;
+    std::vector<std::string> scopes{kAuthzDisabled};
+    catena::Value v;
+    v.set_int32_value(11);
+
+    // through the element's path
+    dm->param("/primes/3")->setValue("peer", v, kParamEnd, scopes);
+    // through the array's path and an element index
+    dm->param("/primes")->setValue("peer", v, 3, scopes);
+    // natively, both ways
+    dm->param("/primes/3")->setValue(int32_t{13});
+    dm->param("/primes")->setValue(int32_t{13}, 3);
+
+    EXPECT_EQ(pushed, (std::vector<Push>(4, Push{"/primes", 3})));
+
+    std::vector<int32_t> primes;
+    dm->param("/primes")->getValue(primes);
+    EXPECT_EQ(primes, (std::vector<int32_t>{2, 3, 5, 13}));
+}
+
+TEST_F(SetValueTest, WholeArrayPushHasNoIndex) {
+    dm->param("/primes")->setValue(std::vector<int32_t>{1, 2});
+    ASSERT_EQ(pushed.size(), 1u);
+    EXPECT_EQ(pushed.front().first, "/primes");
+    EXPECT_EQ(pushed.front().second, kParamEnd);
+}
+
+TEST_F(SetValueTest, TemplateConstraintIsApplied) {
+    std::vector<std::string> scopes{kAuthzDisabled};
+    catena::Value v;
+
+    // the template's constraint is shared, the param only refers to it
+    catena::DeviceComponent_ComponentParam component;
+    dm->param("/gain")->getParam(&component, scopes);
+    EXPECT_EQ(component.param().constraint().kind_case(), catena::Constraint::kRefOid);
+    v.set_int32_value(42);
+    dm->param("/gain")->setValue("peer", v, kParamEnd, scopes);
+    int32_t gain = 0;
+    dm->param("/gain")->getValue(gain);
+    EXPECT_EQ(gain, 10);
+
+    v.set_int32_value(-3);
+    dm->param("/gain")->setValue("peer", v);
+    dm->param("/gain")->getValue(gain);
+    EXPECT_EQ(gain, 0);
+
+    v.set_string_value("turbo");
+    dm->param("/mode")->setValue("peer", v, kParamEnd, scopes);
+    std::string mode;
+    dm->param("/mode")->getValue(mode);
+    EXPECT_EQ(mode, "auto");
+}
+
+TEST_F(SetValueTest, StructIsWrittenWhole) {
+    dm->param("/strip")->setValue(Strip{5, 6});
+    int32_t gain = 0;
+    dm->param("/strip/gain")->getValue(gain);
+    EXPECT_EQ(gain, 5);
+    int32_t pan = 0;
+    dm->param("/strip/pan")->getValue(pan);
+    EXPECT_EQ(pan, 6);
+}
+
+TEST_F(SetValueTest, FailedStructWriteChangesNothing) {
+    catena::Value before;
+    dm->param("/strip")->getValue(&before);
+
+    EXPECT_THROW(dm->param("/strip")->setValue(BadStrip{9, 9}), catena::exception_with_status);
+
+    catena::Value after;
+    dm->param("/strip")->getValue(&after);
+    EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(before, after))
+      << before.DebugString() << "\n" << after.DebugString();
+}
@@ -0,0 +1,102 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+/**
+ * @file RangeConstraintBenchmark.cpp
+ * @brief Measures range constraints applied to arrays against clamping
+ * them one value at a time.
+ * @copyright Copyright (c) 2024 Ross Video
+ */
+
+#include <lite/include/RangeConstraint.h>
+
+#include <lite/param.pb.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+
+using catena::Value;
+
+namespace {
+
+Value makeFloats(std::size_t n) {
+    Value v;
+    auto& floats = *v.mutable_float32_array_values()->mutable_floats();
+    for (std::size_t i = 0; i < n; ++i) {
+        floats.Add(static_cast<float>(i % 200) - 100.0f);
+    }
+    return v;
+}
+
+Value makeInts(std::size_t n) {
+    Value v;
+    auto& ints = *v.mutable_int32_array_values()->mutable_ints();
+    for (std::size_t i = 0; i < n; ++i) {
+        ints.Add(static_cast<int32_t>(i % 200) - 100);
+    }
+    return v;
+}
+
+void BM_FloatArrayClamp_Loop(benchmark::State& state) {
+    Value v = makeFloats(state.range(0));
+    auto& floats = *v.mutable_float32_array_values()->mutable_floats();
+    for (auto _ : state) {
+        for (int i = 0; i < floats.size(); ++i) {
+            floats.Set(i, std::clamp(floats.Get(i), -60.0f, 12.0f));
+        }
+        benchmark::DoNotOptimize(floats.data());
+    }
+    state.SetBytesProcessed(state.iterations() * floats.size() * sizeof(float));
+}
+
+void BM_FloatArrayClamp(benchmark::State& state) {
+    RangeConstraint<float> constraint{-60.0f, 12.0f, "/gain", false};
+    Value v = makeFloats(state.range(0));
+    for (auto _ : state) {
+        constraint.apply(&v);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(float));
+}
+
+void BM_Int32ArrayClamp_Loop(benchmark::State& state) {
+    Value v = makeInts(state.range(0));
+    auto& ints = *v.mutable_int32_array_values()->mutable_ints();
+    for (auto _ : state) {
+        for (int i = 0; i < ints.size(); ++i) {
+            ints.Set(i, std::clamp(ints.Get(i), -60, 12));
+        }
+        benchmark::DoNotOptimize(ints.data());
+    }
+    state.SetBytesProcessed(state.iterations() * ints.size() * sizeof(int32_t));
+}
+
+void BM_Int32ArrayClamp(benchmark::State& state) {
+    RangeConstraint<int32_t> constraint{-60, 12, "/level", false};
+    Value v = makeInts(state.range(0));
+    for (auto _ : state) {
+        constraint.apply(&v);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(int32_t));
+}
+
+}  // namespace
+
+BENCHMARK(BM_FloatArrayClamp_Loop)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_FloatArrayClamp)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_Int32ArrayClamp_Loop)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_Int32ArrayClamp)->RangeMultiplier(16)->Range(16, 1 << 16);
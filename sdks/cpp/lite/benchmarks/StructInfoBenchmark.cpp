@@ -0,0 +1,134 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+/**
+ * @file StructInfoBenchmark.cpp
+ * @brief Measures the array conversions in StructInfo.cpp against the
+ * element-at-a-time loops they replaced.
+ * @copyright Copyright (c) 2024 Ross Video
+ */
+
+#include <lite/include/StructInfo.h>
+
+#include <lite/param.pb.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using catena::Value;
+
+namespace {
+
+// the conversions as they were before bulk copying
+void loopToProto(Value& dst, const std::vector<float>& vec) {
+    dst.clear_float32_array_values();
+    auto& float_array = *dst.mutable_float32_array_values();
+    for (const auto& f : vec) {
+        float_array.add_floats(f);
+    }
+}
+
+void loopFromProto(std::vector<float>& vec, const Value& src) {
+    vec.clear();
+    const auto& float_array = src.float32_array_values();
+    for (int i = 0; i < float_array.floats_size(); ++i) {
+        vec.push_back(float_array.floats(i));
+    }
+}
+
+std::vector<float> makeFloats(std::size_t n) {
+    std::vector<float> vec(n);
+    std::iota(vec.begin(), vec.end(), 0.5f);
+    return vec;
+}
+
+void BM_FloatArrayToProto_Loop(benchmark::State& state) {
+    const auto vec = makeFloats(state.range(0));
+    Value dst;
+    for (auto _ : state) {
+        loopToProto(dst, vec);
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(float));
+}
+
+void BM_FloatArrayToProto(benchmark::State& state) {
+    const auto vec = makeFloats(state.range(0));
+    Value dst;
+    for (auto _ : state) {
+        catena::lite::toProto<std::vector<float>>(dst, &vec);
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(float));
+}
+
+void BM_FloatArrayFromProto_Loop(benchmark::State& state) {
+    Value src;
+    const auto init = makeFloats(state.range(0));
+    catena::lite::toProto<std::vector<float>>(src, &init);
+    std::vector<float> vec;
+    for (auto _ : state) {
+        loopFromProto(vec, src);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations() * init.size() * sizeof(float));
+}
+
+void BM_FloatArrayFromProto(benchmark::State& state) {
+    Value src;
+    const auto init = makeFloats(state.range(0));
+    catena::lite::toProto<std::vector<float>>(src, &init);
+    std::vector<float> vec;
+    for (auto _ : state) {
+        catena::lite::fromProto<std::vector<float>>(&vec, src);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations() * init.size() * sizeof(float));
+}
+
+void BM_Int32ArrayToProto(benchmark::State& state) {
+    std::vector<int32_t> vec(state.range(0));
+    std::iota(vec.begin(), vec.end(), 0);
+    Value dst;
+    for (auto _ : state) {
+        catena::lite::toProto<std::vector<int32_t>>(dst, &vec);
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(int32_t));
+}
+
+void BM_Int32ArrayFromProto(benchmark::State& state) {
+    std::vector<int32_t> init(state.range(0));
+    std::iota(init.begin(), init.end(), 0);
+    Value src;
+    catena::lite::toProto<std::vector<int32_t>>(src, &init);
+    std::vector<int32_t> vec;
+    for (auto _ : state) {
+        catena::lite::fromProto<std::vector<int32_t>>(&vec, src);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations() * init.size() * sizeof(int32_t));
+}
+
+}  // namespace
+
+BENCHMARK(BM_FloatArrayToProto_Loop)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_FloatArrayToProto)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_FloatArrayFromProto_Loop)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_FloatArrayFromProto)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_Int32ArrayToProto)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_Int32ArrayFromProto)->RangeMultiplier(16)->Range(16, 1 << 16);
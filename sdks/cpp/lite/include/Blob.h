@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @file Blob.h
+ * @brief Value type of BINARY and DATA params
+ * @copyright Copyright (c) 2024 Ross Video
+ */
+
+#include <lite/param.pb.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace catena {
+namespace lite {
+
+/**
+ * @brief Holds the value of a BINARY or DATA param, such as a thumbnail, a LUT
+ * or a firmware image, as a reference counted immutable payload.
+ *
+ * Readers take a reference to the current payload rather than a copy of it,
+ * so they can keep using it without holding the device's lock while a writer
+ * replaces it. Replacing the payload is an atomic swap of the reference,
+ * guarded by a lock held only long enough to copy or exchange one pointer.
+ * std::atomic<std::shared_ptr> would do the same but isn't yet available
+ * from every standard library.
+ *
+ * Payloads received from clients are moved into the blob, not copied.
+ * Serializing the param copies the payload into the outgoing message, as
+ * protobuf's bytes fields own their storage and can't share a buffer, so
+ * an update sent to several clients should be serialized once and the
+ * message shared between them, as the gRPC service's Connect streams do.
+ */
+class Blob {
+  public:
+    /**
+     * @brief a reference to an immutable payload
+     */
+    using Payload = std::shared_ptr<const catena::DataPayload>;
+
+    /**
+     * @brief information about the payload, e.g. its mime-type or filename
+     */
+    using Metadata = std::map<std::string, std::string>;
+
+  public:
+    /**
+     * @brief construct a blob with an empty payload
+     */
+    Blob() : payload_{std::make_shared<const catena::DataPayload>()} {}
+
+    /**
+     * @brief construct a blob holding a copy of bytes
+     * @param bytes the payload's data
+     * @param metadata information about the payload for clients to interpret
+     */
+    explicit Blob(const std::string& bytes, const Metadata& metadata = {}) : payload_{make(bytes, metadata)} {}
+
+    /**
+     * @brief Blob does not have copy semantics
+     */
+    Blob(const Blob&) = delete;
+
+    /**
+     * @brief Blob does not have copy semantics
+     */
+    Blob& operator=(const Blob&) = delete;
+
+    /**
+     * @brief get a reference to the current payload
+     * @return the payload, which remains valid after the blob is updated
+     */
+    inline Payload load() const {
+        std::lock_guard lock(mtx_);
+        return payload_;
+    }
+
+    /**
+     * @brief replace the payload
+     * @param payload the new payload
+     */
+    inline void store(Payload payload) {
+        {
+            std::lock_guard lock(mtx_);
+            payload_.swap(payload);
+        }
+        // the previous payload is released outside the lock
+    }
+
+    /**
+     * @brief replace the payload with the contents of payload
+     * @param payload the new payload, left empty by the call
+     */
+    void store(catena::DataPayload&& payload) {
+        auto next = std::make_shared<catena::DataPayload>();
+        next->Swap(&payload);
+        store(Payload{std::move(next)});
+    }
+
+    /**
+     * @brief the size of the current payload's data
+     */
+    inline std::size_t size() const { return load()->payload().size(); }
+
+    /**
+     * @brief make a payload holding a copy of bytes
+     * @param bytes the payload's data
+     * @param metadata information about the payload for clients to interpret
+     */
+    static Payload make(const std::string& bytes, const Metadata& metadata = {}) {
+        auto payload = std::make_shared<catena::DataPayload>();
+        payload->set_payload(bytes);
+        payload->mutable_metadata()->insert(metadata.begin(), metadata.end());
+        return payload;
+    }
+
+  private:
+    Payload payload_;
+    mutable std::mutex mtx_;
+};
+
+}  // namespace lite
+}  // namespace catena
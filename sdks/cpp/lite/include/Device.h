@@ -2,13 +2,21 @@
 
 #include <common/include/Path.h>
 #include <common/include/Enums.h>
+#include <common/include/IConstraint.h>
+#include <common/include/IMenuGroup.h>
+#include <common/include/ILanguagePack.h>
 #include <common/include/vdk/signals.h>
 
+#include <lite/include/Oid.h>
+
 #include <lite/device.pb.h>
 
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <vector>
 #include <cassert>
 #include <type_traits>
@@ -17,9 +25,6 @@ namespace catena {
 namespace lite {
   
 class IParam;         // forward reference
-class IConstraint;    // forward reference
-class IMenuGroup;     // forward reference
-class ILanguagePack;  // forward reference
 
 
 class Device {
@@ -44,6 +49,9 @@ class Device {
     using Scopes = catena::common::Scopes;
     using DetailLevel_e = catena::Device_DetailLevel;
     using DetailLevel = catena::common::DetailLevel;
+    using IConstraint = catena::common::IConstraint;
+    using IMenuGroup = catena::common::IMenuGroup;
+    using ILanguagePack = catena::common::ILanguagePack;
 
     /**
      * @brief ParamTag type for addItem and getItem, and tag-dispatched methods
@@ -80,6 +88,34 @@ class Device {
         using type = ILanguagePack;
     };
 
+    /**
+     * @brief signal emitted when a parameter's value changes, with the oid of
+     * the parameter, the parameter, and the index of the element that changed
+     * or -1 for the whole value
+     */
+    using ValueSetSignal = vdk::signal<void(const std::string&, const IParam*, const int32_t)>;
+
+    /**
+     * @brief A serializer of the descriptors of a model's params, generated
+     * along with the model.
+     *
+     * It writes each param's static descriptor fields from constants and calls
+     * its value serializer directly, rather than through IParam. toProto uses
+     * it while the device holds just the params it was generated for, and
+     * falls back to serializing each param through IParam otherwise.
+     */
+    struct ParamsSerializer {
+        /**
+         * @brief serialize the model's params into params, keyed by oid
+         */
+        void (*serialize)(google::protobuf::Map<std::string, ::catena::Param>& params);
+
+        /**
+         * @brief the number of params serialize writes
+         */
+        std::size_t count;
+    };
+
   public:
     /**
      * @brief Construct a new Device object
@@ -90,9 +126,11 @@ class Device {
      * @brief Construct a new Device object
      */
     Device(uint32_t slot, Device_DetailLevel detail_level, std::vector<Scopes_e> access_scopes,
-           Scopes_e default_scope, bool multi_set_enabled, bool subscriptions)
+           Scopes_e default_scope, bool multi_set_enabled, bool subscriptions,
+           ParamsSerializer params_serializer = {})
         : slot_{slot}, detail_level_{detail_level}, access_scopes_{access_scopes},
-          default_scope_{default_scope}, multi_set_enabled_{multi_set_enabled}, subscriptions_{subscriptions} {}
+          default_scope_{default_scope}, multi_set_enabled_{multi_set_enabled}, subscriptions_{subscriptions},
+          params_serializer_{params_serializer} {}
 
     /**
      * @brief Destroy the Device object
@@ -128,22 +166,25 @@ class Device {
      * item can be a parameter, constraint, menu group, command, or language pack.
      * @param name the name of the item
      * @param item the item to add
+     * @return the item's name, interned in the device's oid table
      */
-    template <typename TAG> void addItem(const std::string& name, TAG::type* item, TAG tag) {
+    template <typename TAG> Oid addItem(std::string_view name, TAG::type* item, TAG tag) {
       assert(item != nullptr);
+      Oid oid = oids_.intern(name);
       if constexpr(std::is_same_v<TAG, ParamTag>) {
-        params_[name] = item;
+        params_[oid] = item;
       } else if constexpr(std::is_same_v<TAG, CommandTag>) {
-        commands_[name] = item;
+        commands_[oid] = item;
       } else if constexpr(std::is_same_v<TAG, ConstraintTag>) {
-        constraints_[name] = item;
+        constraints_[oid] = item;
       } else if constexpr(std::is_same_v<TAG, MenuGroupTag>) {
-        menu_groups_[name] = item;
+        menu_groups_[oid] = item;
       } else if constexpr(std::is_same_v<TAG, LanguagePackTag>) {
-        language_packs_[name] = item;
+        language_packs_[oid] = item;
       } else {
         // static_assert(false, "Unknown TAG type");
       }
+      return oid;
     }
 
     /**
@@ -151,29 +192,39 @@ class Device {
      * item can be an IParameter, IConstraint, IMenuGroup, or ILanguagePack.
      * @param path path to the item relative to device.<items>
      */
-    template <typename TAG> TAG::type* getItem(const std::string& name, TAG tag) const {
+    template <typename TAG> TAG::type* getItem(std::string_view name, TAG tag) const {
+      Oid oid = oids_.find(name);
+      return oid ? getItem(oid, tag) : nullptr;
+    }
+
+    /**
+     * @brief retreive an item from the device by its interned name, without
+     * hashing the name's string.
+     * @param oid the item's name, interned in the device's oid table
+     */
+    template <typename TAG> TAG::type* getItem(Oid oid, TAG) const {
       if constexpr(std::is_same_v<TAG, ParamTag>) {
-        auto it = params_.find(name);
+        auto it = params_.find(oid);
         if (it != params_.end()) {
           return it->second;
         }
       } else if constexpr(std::is_same_v<TAG, CommandTag>) {
-        auto it = commands_.find(name);
+        auto it = commands_.find(oid);
         if (it != commands_.end()) {
           return it->second;
         }
       } else if constexpr(std::is_same_v<TAG, ConstraintTag>) {
-        auto it = constraints_.find(name);
+        auto it = constraints_.find(oid);
         if (it != constraints_.end()) {
           return it->second;
         }
       } else if constexpr(std::is_same_v<TAG, MenuGroupTag>) {
-        auto it = menu_groups_.find(name);
+        auto it = menu_groups_.find(oid);
         if (it != menu_groups_.end()) {
           return it->second;
         }
       } else if constexpr(std::is_same_v<TAG, LanguagePackTag>) {
-        auto it = language_packs_.find(name);
+        auto it = language_packs_.find(oid);
         if (it != language_packs_.end()) {
           return it->second;
         }
@@ -183,6 +234,12 @@ class Device {
       return nullptr;
     }
 
+    /**
+     * @brief the table of the names of the device's items. Each name is
+     * stored once, here, and the device's items are keyed by their ids.
+     */
+    inline const OidTable& oids() const { return oids_; }
+
     /**
      * @brief Create a protobuf representation of the device.
      * @param dst the protobuf representation of the device.
@@ -190,30 +247,132 @@ class Device {
      * are not copied. Design intent is to permit large models to stream their parameters
      * instead of sending a huge device model in one big lump.
      * 
+     * A deep copy also serializes the constraints, params, commands, menu groups and
+     * language packs. Shared constraints are serialized once, into dst.constraints,
+     * and params refer to them by oid.
+     * 
+     * Params are serialized by the model's generated ParamsSerializer if it
+     * has one that covers them all.
+     * 
      * N.B. This method is not thread-safe. It is the caller's responsibility to ensure
      * that the device is not modified while this method is running. This class provides
      * a LockGuard helper class to make this easier.
      */
     void toProto(::catena::Device& dst, bool shallow = true) const;
 
+    /**
+     * @brief get the signal emitted when a client sets the value of the
+     * parameter at oid, or of any parameter below it.
+     *
+     * Unlike valueSetByClient, which every change is sent to, the signal is
+     * only emitted for changes in its subtree, so listeners interested in a
+     * few parameters don't have to filter every change by oid.
+     *
+     * @param oid the oid of the parameter or subtree, e.g. "/counter"
+     * @return the signal, which lives as long as the device
+     */
+    ValueSetSignal& valueSetByClientAt(const std::string& oid) { return subtreeSignal_(clientSignals_, oid); }
+
+    /**
+     * @brief get the signal emitted when the server sets the value of the
+     * parameter at oid, or of any parameter below it.
+     * @param oid the oid of the parameter or subtree, e.g. "/counter"
+     * @return the signal, which lives as long as the device
+     */
+    ValueSetSignal& valueSetByServerAt(const std::string& oid) { return subtreeSignal_(serverSignals_, oid); }
+
+    /**
+     * @brief tell the listeners that a client set the value of a parameter.
+     *
+     * Emits valueSetByClient and the valueSetByClientAt signals of the
+     * parameter and of each subtree it's in.
+     *
+     * @param oid the oid of the parameter
+     * @param param the parameter
+     * @param idx the index of the element set, or -1 for the whole value
+     * @note call with the device's lock held
+     */
+    void notifyValueSetByClient(const std::string& oid, const IParam* param, int32_t idx) const {
+        valueSetByClient.emit(oid, param, idx);
+        emitSubtree_(clientSignals_, oid, param, idx);
+    }
+
+    /**
+     * @brief tell the listeners that the server set the value of a parameter.
+     *
+     * Emits valueSetByServer and the valueSetByServerAt signals of the
+     * parameter and of each subtree it's in.
+     *
+     * @param oid the oid of the parameter
+     * @param param the parameter
+     * @param idx the index of the element set, or -1 for the whole value
+     * @note call with the device's lock held
+     */
+    void notifyValueSetByServer(const std::string& oid, const IParam* param, int32_t idx) const {
+        valueSetByServer.emit(oid, param, idx);
+        emitSubtree_(serverSignals_, oid, param, idx);
+    }
+
   public:
-    vdk::signal<void(const std::string&, const IParam*, const int32_t)> valueSetByClient;
-    vdk::signal<void(const std::string&, const IParam*, const int32_t)> valueSetByServer;
+    /**
+     * @brief emitted for every change made by a client, see valueSetByClientAt
+     * to listen to a single parameter or subtree
+     */
+    ValueSetSignal valueSetByClient;
+
+    /**
+     * @brief emitted for every change made by the server, see
+     * valueSetByServerAt to listen to a single parameter or subtree
+     */
+    ValueSetSignal valueSetByServer;
+
+  private:
+    /**
+     * @brief hashes strings and string_views alike, so subtrees can be found
+     * without copying the oid's prefixes
+     */
+    struct OidHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view oid) const { return std::hash<std::string_view>{}(oid); }
+    };
+
+    /**
+     * @brief the signals of the parameters and subtrees that have listeners.
+     * Signals are only ever added, so references to them stay valid.
+     */
+    struct SubtreeSignals {
+        std::unordered_map<std::string, std::unique_ptr<ValueSetSignal>, OidHash, std::equal_to<>> signals;
+        mutable std::shared_mutex mutex;
+    };
+
+    /**
+     * @brief find or add the signal of a parameter or subtree
+     */
+    static ValueSetSignal& subtreeSignal_(SubtreeSignals& subtrees, const std::string& oid);
+
+    /**
+     * @brief emit the signals of oid and of each subtree it's in, deepest first
+     */
+    static void emitSubtree_(const SubtreeSignals& subtrees, const std::string& oid, const IParam* param, int32_t idx);
 
   private:
     uint32_t slot_;
     Device_DetailLevel detail_level_;
-    std::unordered_map<std::string, IConstraint*> constraints_;
-    std::unordered_map<std::string, IParam*> params_;
-    std::unordered_map<std::string, IMenuGroup*> menu_groups_;
-    std::unordered_map<std::string, IParam*> commands_;
-    std::unordered_map<std::string, ILanguagePack*> language_packs_;
+    OidTable oids_;
+    std::unordered_map<Oid, IConstraint*, Oid::Hash> constraints_;
+    std::unordered_map<Oid, IParam*, Oid::Hash> params_;
+    std::unordered_map<Oid, IMenuGroup*, Oid::Hash> menu_groups_;
+    std::unordered_map<Oid, IParam*, Oid::Hash> commands_;
+    std::unordered_map<Oid, ILanguagePack*, Oid::Hash> language_packs_;
     std::vector<Scopes_e> access_scopes_;
     Scopes default_scope_;
     bool multi_set_enabled_;
     bool subscriptions_;
+    ParamsSerializer params_serializer_;
 
     mutable std::mutex mutex_;
+    SubtreeSignals clientSignals_;
+    SubtreeSignals serverSignals_;
 };
 }  // namespace lite
 }  // namespace catena
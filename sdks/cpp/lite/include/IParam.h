@@ -4,6 +4,11 @@
 #include <lite/param.pb.h>
 
 #include <Enums.h>
+#include <IConstraint.h>
+
+#include <lite/include/Oid.h>
+
+#include <cstdint>
 
 namespace catena {
 class Value; // forward reference
@@ -14,6 +19,14 @@ namespace lite {
 class IParam {
   public:
     using ParamType = catena::patterns::EnumDecorator<catena::ParamType>;
+
+    /**
+     * @brief element index that addresses the end of an array param. Writing
+     * an element there appends it, reading or notifying there means the whole value.
+     * As a signed index, as used by Device's signals, it's -1.
+     */
+    static constexpr uint32_t kEnd = UINT32_MAX;
+
   public:
     IParam() : oid_{} {}
     IParam(IParam&&) = default;
@@ -33,6 +46,29 @@ class IParam {
      */
     virtual void fromProto(catena::Value& src) = 0;
 
+    /**
+     * @brief serialize one element of an array parameter to protobuf
+     * @param dst the protobuf value to serialize to
+     * @param idx the element to serialize, kEnd serializes the whole value as
+     * does any index if the parameter is not an array
+     * @throws catena::exception_with_status OUT_OF_RANGE if idx is past the end of the array
+     */
+    virtual void toProto(catena::Value& dst, uint32_t idx) const = 0;
+
+    /**
+     * @brief deserialize one element of an array parameter from protobuf
+     *
+     * If src holds a single element of an array parameter it's written in place
+     * at idx, or appended if idx is kEnd. Otherwise src is deserialized as the
+     * whole value, like fromProto(src).
+     * @param src the protobuf value to deserialize from
+     * @param idx the element to write
+     * @return the index of the element written, or kEnd if the whole value was
+     * @throws catena::exception_with_status OUT_OF_RANGE if idx is past the end of the array
+     * @note this method may constrain the source value and modify it
+     */
+    virtual uint32_t fromProto(catena::Value& src, uint32_t idx) = 0;
+
     /**
      * @brief serialize the parameter descriptor to protobuf
      * @param param the protobuf value to serialize to
@@ -45,18 +81,31 @@ class IParam {
      * @brief return the oid of the param
      * @return the oid of the param
      */
-    inline const std::string& getOid() const { return oid_; };
+    inline const std::string& getOid() const { return oid_.str(); };
+
+    /**
+     * @brief return the oid of the param as interned by its device, to find
+     * the param or key other data by it without hashing its string
+     * @return the interned oid of the param
+     */
+    inline Oid getInternedOid() const { return oid_; };
 
     /**
      * @brief set the oid of the param
-     * @param oid the new oid to set
+     * @param oid the new oid to set, interned by the param's device
      */
-    void setOid(const std::string& oid) { oid_ = oid; };
+    void setOid(Oid oid) { oid_ = oid; };
 
     virtual const bool isReadOnly() const = 0;
 
+    /**
+     * @brief get the constraint applied to the param's value
+     * @return the constraint, or nullptr if the param is unconstrained
+     */
+    virtual const catena::common::IConstraint* getConstraint() const = 0;
+
    protected:
-    std::string oid_;
+    Oid oid_;
 };
 }  // namespace lite
 
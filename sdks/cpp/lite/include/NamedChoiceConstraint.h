@@ -11,6 +11,17 @@
 #include <common/include/IConstraint.h>
 #include <google/protobuf/message_lite.h>
 #include <lite/include/PolyglotText.h>
+#include <lite/include/Device.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Named choice constraint, ensures a value is within a named choice
@@ -28,9 +39,9 @@ public:
      */
     using PolyglotText = catena::lite::PolyglotText;
     /**
-     * @brief map of choices with their display names
+     * @brief choices with their display names, in the order they were given
      */
-    using Choices = std::unordered_map<T, PolyglotText>;
+    using Choices = std::vector<std::pair<T, PolyglotText>>;
     /**
      * @brief initializer list for choices
      */
@@ -47,7 +58,58 @@ public:
      */
     NamedChoiceConstraint(ListInitializer init, bool strict, std::string oid, bool shared)
         : IConstraint{oid, shared}, choices_{init.begin(), init.end()}, 
-        strict_{strict}, default_{init.begin()->first} {}
+        strict_{strict}, default_{init.begin()->first} {
+        compile_();
+    }
+
+    /**
+     * @brief Construct a new Named Choice Constraint object and add it to the device
+     * @param init the list of choices
+     * @param strict should the value be constrained if not in choices
+     * @param oid the oid of the constraint
+     * @param shared is the constraint shared
+     * @param dm the device to add the constraint to
+     * @note  the first choice provided will be the default for the constraint
+     */
+    NamedChoiceConstraint(ListInitializer init, bool strict, std::string oid, bool shared, catena::lite::Device& dm)
+        : NamedChoiceConstraint(init, strict, oid, shared) {
+        dm.addItem<catena::lite::Device::ConstraintTag>(oid, this, catena::lite::Device::ConstraintTag{});
+    }
+
+    /**
+     * @brief Construct a choice constraint whose choices are their own names,
+     * serialized as a STRING_CHOICE
+     * @param init the list of choices
+     * @param strict should the value be constrained if not in choices
+     * @param oid the oid of the constraint
+     * @param shared is the constraint shared
+     * @note  the first choice provided will be the default for the constraint
+     */
+    NamedChoiceConstraint(std::initializer_list<T> init, bool strict, std::string oid, bool shared)
+        requires std::is_same_v<T, std::string>
+        : IConstraint{oid, shared}, strict_{strict}, default_{*init.begin()}, named_{false} {
+        choices_.reserve(init.size());
+        for (const T& value : init) {
+            choices_.emplace_back(std::piecewise_construct, std::forward_as_tuple(value), std::forward_as_tuple());
+        }
+        compile_();
+    }
+
+    /**
+     * @brief Construct a choice constraint whose choices are their own names
+     * and add it to the device
+     * @param init the list of choices
+     * @param strict should the value be constrained if not in choices
+     * @param oid the oid of the constraint
+     * @param shared is the constraint shared
+     * @param dm the device to add the constraint to
+     * @note  the first choice provided will be the default for the constraint
+     */
+    NamedChoiceConstraint(std::initializer_list<T> init, bool strict, std::string oid, bool shared, catena::lite::Device& dm)
+        requires std::is_same_v<T, std::string>
+        : NamedChoiceConstraint(init, strict, oid, shared) {
+        dm.addItem<catena::lite::Device::ConstraintTag>(oid, this, catena::lite::Device::ConstraintTag{});
+    }
 
     /**
      * @brief applies choice constraint to a catena::Value if strict
@@ -61,7 +123,7 @@ public:
             if (!src_val.has_int32_value()) { return; }
 
             // constrain if strict and src is not in choices
-            if (strict_ && !choices_.contains(src_val.int32_value())) {
+            if (strict_ && !contains_(src_val.int32_value())) {
                 src_val.set_int32_value(default_);
             }
         }
@@ -71,7 +133,7 @@ public:
             if (!src_val.has_string_value()) { return; }
 
             // constrain if strict and src is not in choices
-            if (strict_ && !choices_.contains(src_val.float32_value())) {
+            if (strict_ && !contains_(src_val.string_value())) {
                 src_val.set_string_value(default_);
             }
         } 
@@ -94,6 +156,15 @@ public:
         }
 
         if constexpr(std::is_same<T, std::string>::value) {
+            if (!named_) {
+                constraint.set_type(catena::Constraint::STRING_CHOICE);
+                auto& stringChoice = *constraint.mutable_string_choice();
+                for (auto& [value, name] : choices_) {
+                    stringChoice.add_choices(value);
+                }
+                stringChoice.set_strict(strict_);
+                return;
+            }
             constraint.set_type(catena::Constraint::STRING_STRING_CHOICE);
             for (auto& [value, name] : choices_) {
                 auto stringChoice = constraint.mutable_string_string_choice()->add_choices();
@@ -104,7 +175,65 @@ public:
     }
 
 private:
+    /**
+     * @brief build the lookup structure that suits the choices
+     *
+     * Integer choices that are dense enough are kept in a bitmap, at a bit per
+     * value in their range. Up to 32 bits per choice, that's no more memory,
+     * give or take a word, than the 4 byte keys of a sorted vector would take.
+     * Otherwise the choices are kept sorted and found by binary search, which
+     * is also how strings are found without hashing them.
+     */
+    void compile_() {
+        if constexpr(std::is_same<T, int32_t>::value) {
+            auto [lo, hi] = std::minmax_element(choices_.begin(), choices_.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+            base_ = lo->first;
+            const uint64_t span = static_cast<uint64_t>(int64_t{hi->first} - int64_t{lo->first}) + 1;
+            if (span <= 32 * choices_.size()) {
+                span_ = static_cast<uint32_t>(span);
+                bitmap_.assign((span + 63) / 64, 0);
+                for (const auto& [value, name] : choices_) {
+                    const uint32_t bit = static_cast<uint32_t>(value) - static_cast<uint32_t>(base_);
+                    bitmap_[bit >> 6] |= uint64_t{1} << (bit & 63);
+                }
+                return;
+            }
+        }
+        sorted_.reserve(choices_.size());
+        for (const auto& [value, name] : choices_) {
+            sorted_.push_back(value);
+        }
+        std::sort(sorted_.begin(), sorted_.end());
+    }
+
+    /**
+     * @brief is v one of the choices
+     */
+    bool contains_(int32_t v) const {
+        if (!bitmap_.empty()) {
+            // values below base_ wrap around to large offsets
+            const uint32_t bit = static_cast<uint32_t>(v) - static_cast<uint32_t>(base_);
+            return bit < span_ && ((bitmap_[bit >> 6] >> (bit & 63)) & 1);
+        }
+        return std::binary_search(sorted_.begin(), sorted_.end(), v);
+    }
+
+    /**
+     * @brief is v one of the choices
+     */
+    bool contains_(std::string_view v) const {
+        auto it = std::lower_bound(sorted_.begin(), sorted_.end(), v,
+            [](const std::string& a, std::string_view b) { return std::string_view{a} < b; });
+        return it != sorted_.end() && std::string_view{*it} == v;
+    }
+
     Choices choices_; ///< the choices
     bool strict_;     ///< should the value be constrained on apply
     T default_;       ///< the default value to constrain to
+    std::vector<T> sorted_;         ///< the choices' values in order, unless they're in the bitmap
+    std::vector<uint64_t> bitmap_;  ///< bit i is set if base_ + i is a choice
+    int32_t base_ = 0;              ///< the smallest choice in the bitmap
+    uint32_t span_ = 0;             ///< the number of bits in the bitmap
+    bool named_ = true;             ///< false if the choices are their own names
 };
@@ -0,0 +1,156 @@
+#pragma once
+
+/**
+ * @file Oid.h
+ * @brief Interned object ids
+ * @copyright Copyright (c) 2024 Ross Video
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace catena {
+namespace lite {
+
+/**
+ * @brief An oid interned in an OidTable.
+ *
+ * A handle to the table's single copy of the oid's string, and to the id
+ * given to it, so that it can be stored, compared and hashed without copying
+ * or rehashing the string. Handles are only valid while their table exists.
+ */
+class Oid {
+  public:
+    /**
+     * @brief the id of an oid that isn't interned
+     */
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    /**
+     * @brief hashes an oid by its id
+     */
+    struct Hash {
+        size_t operator()(const Oid& oid) const { return oid.id(); }
+    };
+
+  public:
+    /**
+     * @brief construct a handle that refers to no oid
+     */
+    Oid() = default;
+
+    /**
+     * @brief the oid's string, empty if the handle refers to no oid
+     */
+    inline const std::string& str() const { return entry_ != nullptr ? entry_->str : empty_(); }
+
+    /**
+     * @brief the oid's id, unique within its table and assigned from 0 in
+     * the order the oids were interned, or kNone
+     */
+    inline uint32_t id() const { return entry_ != nullptr ? entry_->id : kNone; }
+
+    /**
+     * @brief does the handle refer to an oid
+     */
+    inline explicit operator bool() const { return entry_ != nullptr; }
+
+    /**
+     * @brief oids of the same table are the same if their handles are
+     */
+    inline bool operator==(const Oid& other) const { return entry_ == other.entry_; }
+
+  private:
+    friend class OidTable;
+
+    /**
+     * @brief the table's record of an oid
+     */
+    struct Entry {
+        std::string str;
+        uint32_t id;
+    };
+
+    explicit Oid(const Entry* entry) : entry_{entry} {}
+
+    static const std::string& empty_() {
+        static const std::string empty;
+        return empty;
+    }
+
+    const Entry* entry_ = nullptr;
+};
+
+/**
+ * @brief Gives each oid added to it a stable id and a single string instance.
+ *
+ * Interning hashes the oid's string once. Anything keyed by the resulting Oid,
+ * such as the device's items, is then found by its id.
+ *
+ * Like the rest of the device model, the table is filled in when the model is
+ * constructed and not modified while it's being served, so it has no lock.
+ */
+class OidTable {
+  public:
+    OidTable() = default;
+
+    /**
+     * @brief OidTable does not have copy semantics, its oids refer to it
+     */
+    OidTable(const OidTable&) = delete;
+
+    /**
+     * @brief OidTable does not have copy semantics, its oids refer to it
+     */
+    OidTable& operator=(const OidTable&) = delete;
+
+    /**
+     * @brief get the interned oid, adding it if it's new
+     * @param oid the oid
+     * @return the interned oid, valid as long as the table
+     */
+    Oid intern(std::string_view oid) {
+        auto it = index_.find(oid);
+        if (it != index_.end()) {
+            return Oid{it->second};
+        }
+        const Oid::Entry& entry = entries_.emplace_back(Oid::Entry{std::string{oid}, static_cast<uint32_t>(entries_.size())});
+        index_.emplace(std::string_view{entry.str}, &entry);
+        return Oid{&entry};
+    }
+
+    /**
+     * @brief get the interned oid, without adding it
+     * @param oid the oid
+     * @return the interned oid, or one that refers to no oid if it's not interned
+     */
+    Oid find(std::string_view oid) const {
+        auto it = index_.find(oid);
+        return it != index_.end() ? Oid{it->second} : Oid{};
+    }
+
+    /**
+     * @brief get the oid with an id
+     * @param id the id, less than size()
+     */
+    inline Oid at(uint32_t id) const { return Oid{&entries_.at(id)}; }
+
+    /**
+     * @brief the number of oids interned
+     */
+    inline size_t size() const { return entries_.size(); }
+
+  private:
+    // a deque doesn't move its elements as it grows, so the index's keys and
+    // the handles given out stay valid
+    std::deque<Oid::Entry> entries_;
+    std::unordered_map<std::string_view, const Oid::Entry*> index_;
+};
+
+}  // namespace lite
+}  // namespace catena
@@ -15,12 +15,14 @@
 #include <lite/include/StructInfo.h>
 #include <lite/include/PolyglotText.h>
 #include <common/include/IConstraint.h>
+#include <common/include/Status.h>
 
 #include <lite/param.pb.h>
 
 #include <functional>  // reference_wrapper
 #include <vector>
 #include <string>
+#include <sstream>
 
 namespace catena {
 namespace lite {
@@ -73,16 +75,112 @@ public:
      */
     Param(catena::ParamType type, T& value, const OidAliases& oid_aliases, const PolyglotText::ListInitializer name, const std::string& widget, 
         const bool read_only, catena::common::IConstraint* constraint, const std::string& oid, Device& dm)
-        : type_{type}, value_{value}, oid_aliases_{oid_aliases}, name_{name}, widget_{widget}, constraint_{constraint}, dm_{dm} {
-        setOid(oid);
-        dm.addItem<Device::ParamTag>(oid, this, Device::ParamTag{});
+        : type_{type}, value_{value}, oid_aliases_{oid_aliases}, name_{name}, widget_{widget}, constraint_{constraint},
+          dm_{dm}, read_only_{read_only} {
+        setOid(dm.addItem<Device::ParamTag>(oid, this, Device::ParamTag{}));
     }
 
+    /**
+     * @brief Scoped update of the parameter's value by the server.
+     *
+     * Holds the device's lock for its lifetime and gives direct access to the
+     * value, so that several changes to it can be made as one. When it goes
+     * out of scope the value is compared with the one it started with and,
+     * if it changed, the version is bumped and valueSetByServer is emitted.
+     *
+     * @code
+     * {
+     *     auto location = locationParam.update();
+     *     location->latitude = 45.4215;
+     *     location->longitude = -75.6972;
+     * }   // one notification, sent only if the location moved
+     * @endcode
+     */
+    class Update {
+      public:
+        /**
+         * @brief lock the device and take a copy of the value to compare with
+         * @param param the parameter to update
+         */
+        explicit Update(Param& param) : lock_{param.dm_.get()}, param_{param}, before_{param.get()} {}
+
+        /**
+         * @brief Update does not have copy semantics
+         */
+        Update(const Update&) = delete;
+
+        /**
+         * @brief Update does not have copy semantics
+         */
+        Update& operator=(const Update&) = delete;
+
+        /**
+         * @brief notify if the value changed, then unlock the device
+         */
+        ~Update() {
+            if (!(param_.get() == before_)) {
+                param_.notify_();
+            }
+        }
+
+        /**
+         * @brief the value being updated
+         */
+        inline T& operator*() const { return param_.get(); }
+
+        /**
+         * @brief the value being updated
+         */
+        inline T* operator->() const { return &param_.get(); }
+
+      private:
+        Device::LockGuard lock_;
+        Param& param_;
+        const T before_;
+    };
+
     /**
      * @brief get the value of the parameter
+     * @note the device's lock should be held while using it, see update()
+     * and set() for server side changes
      */
     inline T& get() { return value_.get(); }
 
+    /**
+     * @brief set the value of the parameter from the server
+     *
+     * Locks the device and, if value differs from the current one, assigns
+     * it, bumps the version and emits valueSetByServer. Setting the value it
+     * already has does nothing, so no redundant updates are pushed.
+     *
+     * @param value the new value
+     * @return true if the value changed
+     * @note the device must not already be locked by the caller
+     */
+    bool set(const T& value) {
+        Device::LockGuard lg(dm_.get());
+        if (value_.get() == value) {
+            return false;
+        }
+        value_.get() = value;
+        notify_();
+        return true;
+    }
+
+    /**
+     * @brief begin a scoped update of the parameter's value from the server
+     * @return the update, which holds the device's lock until destroyed
+     * @note the device must not already be locked by the caller
+     */
+    inline Update update() { return Update{*this}; }
+
+    /**
+     * @brief the number of times the value has been changed through
+     * fromProto, e.g. by a client, or by the server through set() or update()
+     * @note read it with the device's lock held
+     */
+    inline uint64_t version() const { return version_; }
+
     /**
      * @brief serialize the parameter value to protobuf
      * @param dst the protobuf value to serialize to
@@ -92,9 +190,64 @@ public:
     /**
      * @brief deserialize the parameter value from protobuf
      * @param src the protobuf value to deserialize from
-     * @note this method may constrain the source value and modify it
+     * @note this method may constrain the source value and modify it, and
+     * moves the payload out of it if the parameter is a Blob
+     */
+    void fromProto(catena::Value& src) override {
+        assign_(src);
+        ++version_;
+    }
+
+    /**
+     * @brief serialize one element of the parameter value to protobuf
+     * @param dst the protobuf value to serialize to
+     * @param idx the element to serialize, or kEnd for the whole value
      */
-    void fromProto(catena::Value& src) override;
+    void toProto(catena::Value& dst, uint32_t idx) const override {
+        if constexpr (meta::is_vector<T>) {
+            if (idx != kEnd) {
+                const T& value = value_.get();
+                checkIndex_(idx, value.size());
+                catena::lite::toProto<typename T::value_type>(dst, &value[idx]);
+                return;
+            }
+        }
+        toProto(dst);
+    }
+
+    /**
+     * @brief deserialize one element of the parameter value from protobuf
+     * @param src the protobuf value to deserialize from
+     * @param idx the element to write, or kEnd to append
+     * @return the index written, or kEnd if src held the whole value
+     */
+    uint32_t fromProto(catena::Value& src, uint32_t idx) override {
+        if constexpr (meta::is_vector<T>) {
+            using E = typename T::value_type;
+            if (isElement_<E>(src)) {
+                T& value = value_.get();
+                if (idx != kEnd) {
+                    checkIndex_(idx, value.size());
+                }
+                if (constraint_) {
+                    constraint_->apply(&src);
+                }
+                if (idx == kEnd) {
+                    // converted before it's appended, so a bad element adds nothing
+                    E element{};
+                    catena::lite::fromProto<E>(&element, src);
+                    value.push_back(std::move(element));
+                    idx = static_cast<uint32_t>(value.size() - 1);
+                } else {
+                    catena::lite::fromProto<E>(&value[idx], src);
+                }
+                ++version_;
+                return idx;
+            }
+        }
+        fromProto(src);
+        return kEnd;
+    }
 
     /**
      * @brief serialize the parameter descriptor to protobuf
@@ -111,18 +264,22 @@ public:
         }
 
         // name member
-        catena::PolyglotText name_proto;
-        for (const auto& [lang, text] : name_.displayStrings()) {
-            (*name_proto.mutable_display_strings())[lang] = text;
-        }
-        param.mutable_name()->Swap(&name_proto);
+        name_.toProto(*param.mutable_name());
 
         // widget member
         param.set_widget(widget_);
 
-        // constraint member
+        // read_only member
+        param.set_read_only(read_only_);
+
+        // constraint member, shared constraints are referenced by oid and
+        // serialized once as part of the device
         if (constraint_ != nullptr) {
-            constraint_->toProto(*param.mutable_constraint());
+            if (constraint_->getShared()) {
+                param.mutable_constraint()->set_ref_oid(constraint_->getOid());
+            } else {
+                constraint_->toProto(*param.mutable_constraint());
+            }
         }
 
         // value member
@@ -148,6 +305,12 @@ public:
 
     void setReadOnly(bool read_only) { read_only_ = read_only; }
 
+    /**
+     * @brief get the constraint applied to the parameter's value
+     * @return the constraint, or nullptr if the parameter is unconstrained
+     */
+    const catena::common::IConstraint* getConstraint() const override { return constraint_; }
+
     /**
      * @brief get the parameter name by language
      * @param language the language to get the name for
@@ -164,6 +327,55 @@ public:
     }
 
 private:
+    /**
+     * @brief assign the value in src to the parameter, specialized for each
+     * value type
+     * @param src the protobuf value to deserialize from
+     * @throws catena::exception_with_status if src can't be assigned, in
+     * which case the version isn't bumped
+     */
+    void assign_(catena::Value& src);
+
+    /**
+     * @brief record a change made by the server and tell the connections
+     * @note called with the device's lock held
+     */
+    void notify_() {
+        ++version_;
+        dm_.get().notifyValueSetByServer(getOid(), this, static_cast<int32_t>(kEnd));
+    }
+
+    /**
+     * @brief does src hold a single element of type E
+     */
+    template <typename E>
+    static bool isElement_(const catena::Value& src) {
+        if constexpr (std::is_same_v<E, int32_t>) {
+            return src.has_int32_value();
+        } else if constexpr (std::is_same_v<E, float>) {
+            return src.has_float32_value();
+        } else if constexpr (std::is_same_v<E, std::string>) {
+            return src.has_string_value();
+        } else if constexpr (meta::has_getStructInfo<E>) {
+            return src.has_struct_value();
+        } else if constexpr (meta::has_getVariantInfo<E>) {
+            return src.has_struct_variant_value();
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * @brief throw if idx doesn't address an element of an array of the given size
+     */
+    void checkIndex_(uint32_t idx, std::size_t size) const {
+        if (idx >= size) {
+            std::stringstream why;
+            why << __PRETTY_FUNCTION__ << "\nelement " << idx << " of '" << getOid() << "' is out of range, size is " << size;
+            throw catena::exception_with_status(why.str(), catena::StatusCode::OUT_OF_RANGE);
+        }
+    }
+
     ParamType type_;  // ParamType is from param.pb.h
     std::vector<std::string> oid_aliases_;
     PolyglotText name_;
@@ -172,6 +384,7 @@ private:
     std::reference_wrapper<Device> dm_;
     std::string widget_;
     bool read_only_;
+    uint64_t version_ = 0;
 };
 
 }  // namespace lite
@@ -10,28 +10,47 @@
 
 namespace catena {
 namespace lite {
+/**
+ * @brief Text in several languages, e.g. a param's or a choice's name.
+ *
+ * The display strings are interned in a process-wide pool, and PolyglotText
+ * is a handle to its pooled copy. Models repeat the same names, such as
+ * "Gain" or "Mute" in every language they support, thousands of times, and
+ * each distinct set of display strings is stored only once. Pooled strings
+ * are immutable and live as long as the process.
+ */
 class PolyglotText : public catena::common::IPolyglotText {
   public:
     using DisplayStrings = std::unordered_map<std::string, std::string>;
 
   public:
-    PolyglotText(const DisplayStrings& display_strings) : display_strings_(display_strings) {}
-    PolyglotText() = default;
+    PolyglotText(const DisplayStrings& display_strings) : display_strings_(&intern_(DisplayStrings{display_strings})) {}
+    PolyglotText() : display_strings_(&intern_(DisplayStrings{})) {}
     PolyglotText(PolyglotText&&) = default;
     PolyglotText& operator=(PolyglotText&&) = default;
     virtual ~PolyglotText() = default;
 
     // Constructor from initializer list
     PolyglotText(ListInitializer list)
-      : display_strings_(list.begin(), list.end()) {}
+      : display_strings_(&intern_(DisplayStrings(list.begin(), list.end()))) {}
 
 
     void toProto(google::protobuf::MessageLite& dst) const override;
 
-    inline const DisplayStrings& displayStrings() const override { return display_strings_; }
+    inline const DisplayStrings& displayStrings() const override { return *display_strings_; }
+
+    /**
+     * @brief the number of distinct sets of display strings in the pool
+     */
+    static std::size_t poolSize();
 
   private:
-    DisplayStrings display_strings_;
+    /**
+     * @brief find the pooled copy of display_strings, adding it if it's new
+     */
+    static const DisplayStrings& intern_(DisplayStrings&& display_strings);
+
+    const DisplayStrings* display_strings_;
 };
 }  // namespace lite
-}  // namespace catena
\ No newline at end of file
+}  // namespace catena
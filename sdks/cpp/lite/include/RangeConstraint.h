@@ -10,6 +10,8 @@
  */
 
 #include <common/include/IConstraint.h>
+#include <common/include/Clamp.h>
+#include <lite/include/Device.h>
 #include  <google/protobuf/message_lite.h>
 
 /**
@@ -50,35 +52,51 @@ public:
         : IConstraint{oid, shared}, min_(min), max_(max), step_(step),
         display_min_{display_min}, display_max_{display_max} {}
 
+    /**
+     * @brief Construct a new Range Constraint object and add it to the device
+     * @param min the minimum value
+     * @param max the maximum value
+     * @param step the step size
+     * @param display_min the minimum value to display
+     * @param display_max the maximum value to display
+     * @param oid the oid of the constraint
+     * @param shared is the constraint shared
+     * @param dm the device to add the constraint to
+     */
+    RangeConstraint(T min, T max, T step, T display_min, T display_max, std::string oid, bool shared,
+        catena::lite::Device& dm)
+        : RangeConstraint(min, max, step, display_min, display_max, oid, shared) {
+        dm.addItem<catena::lite::Device::ConstraintTag>(oid, this, catena::lite::Device::ConstraintTag{});
+    }
+
     /**
      * @brief applies range constraint to a catena::Value
-     * @param src a catena::Value to apply the constraint to
+     * @param src a catena::Value to apply the constraint to, either a
+     * single number or an array of them
      */
     void apply(void* src) const override {
         auto& src_val = *reinterpret_cast<catena::Value*>(src);
 
         if constexpr(std::is_same<T, int32_t>::value) {
-            // ignore the request if src is not valid
-            if (!src_val.has_int32_value()) { return; }
-            
-            // constrain if not within allowed range
-            if (src_val.int32_value() < min_) {
-                src_val.set_int32_value(min_);
-            } else if (src_val.int32_value() > max_) {
-                src_val.set_int32_value(max_);
+            if (src_val.has_int32_value()) {
+                // constrain if not within allowed range
+                src_val.set_int32_value(catena::clamp(src_val.int32_value(), min_, max_));
+            } else if (src_val.has_int32_array_values()) {
+                auto& ints = *src_val.mutable_int32_array_values()->mutable_ints();
+                catena::clamp(std::span<int32_t>(ints.mutable_data(), ints.size()), min_, max_);
             }
+            // otherwise src is not valid, ignore the request
         }
 
         if constexpr(std::is_same<T, float>::value) {
-            // ignore the request if src is not valid
-            if (!src_val.has_float32_value()) { return; }
-
-            // constrain if not within allowed range
-            if (src_val.float32_value() < min_) {
-                src_val.set_float32_value(min_);
-            } else if (src_val.float32_value() > max_) {
-                src_val.set_float32_value(max_);
+            if (src_val.has_float32_value()) {
+                // constrain if not within allowed range
+                src_val.set_float32_value(catena::clamp(src_val.float32_value(), min_, max_));
+            } else if (src_val.has_float32_array_values()) {
+                auto& floats = *src_val.mutable_float32_array_values()->mutable_floats();
+                catena::clamp(std::span<float>(floats.mutable_data(), floats.size()), min_, max_);
             }
+            // otherwise src is not valid, ignore the request
         }
     }
 
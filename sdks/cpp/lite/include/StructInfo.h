@@ -3,8 +3,15 @@
 #include <common/include/meta/Typelist.h>
 #include <lite/param.pb.h>
 
+#include <common/include/Status.h>
+
 #include <string>
+#include <string_view>
+#include <span>
+#include <sstream>
 #include <cstddef>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace catena {
@@ -13,34 +20,44 @@ namespace lite {
 /**
  * @brief FieldInfo is a struct that contains information about a field in a struct
  *
+ * It's a literal type so that the code generator can emit each struct's fields
+ * as a constexpr table, with plain function pointers the compiler can see through.
  */
 struct FieldInfo {
-    std::string name; /*< the name of the field */
-    std::size_t offset; /*< the field's offset from the base of its enclosing struct */
-
     /**
-     * @brief a function that converts a field to a protobuf value
+     * @brief signature of the function that converts a field to a protobuf value
      *
      * @param dst the destination protobuf value
      * @param src the source value
-     * 
-     * The code generator points this to the appropriate toProto method
-     * for the field's type
-     * 
      */
-    std::function<void(catena::Value&, const void*)> toProto;
+    using ToProto = void (*)(catena::Value& dst, const void* src);
 
     /**
-     * @brief a function that converts a protobuf value to a field
+     * @brief signature of the function that converts a protobuf value to a field
      *
      * @param dst the destination value
      * @param src the source protobuf value
+     */
+    using FromProto = void (*)(void* dst, const catena::Value& src);
+
+    std::string_view name; /*< the name of the field */
+    std::size_t offset; /*< the field's offset from the base of its enclosing struct */
+
+    /**
+     * @brief converts the field to a protobuf value
      * 
-     * The code generator points this to the appropriate fromProto method
+     * The code generator points this to the appropriate toProto method
      * for the field's type
+     */
+    ToProto toProto;
+
+    /**
+     * @brief converts a protobuf value to the field
      * 
+     * The code generator points this to the appropriate fromProto method
+     * for the field's type
      */
-    std::function<void(void*, const catena::Value&)> fromProto;
+    FromProto fromProto;
 };
 
 /**
@@ -49,8 +66,21 @@ struct FieldInfo {
  *
  */
 struct StructInfo {
-    std::string name; /*< the struct's type name */
-    std::vector<FieldInfo> fields; /*< information about its fields */
+    std::string_view name; /*< the struct's type name */
+    std::span<const FieldInfo> fields; /*< information about its fields */
+};
+
+/**
+ * @brief VariantInfo is a struct that contains information about a struct variant
+ * defined in the Catena device model.
+ *
+ * The code generator derives each variant type from a std::variant whose
+ * alternatives are listed in the same order as their names here, so the
+ * active alternative's name is found by its index.
+ */
+struct VariantInfo {
+    std::string_view name; /*< the variant's type name */
+    std::span<const std::string_view> alternatives; /*< names of its alternatives, by index */
 };
 }  // namespace lite
 
@@ -75,37 +105,211 @@ template <typename T, typename = void> constexpr bool has_getStructInfo{};
 template <typename T>
 constexpr bool has_getStructInfo<T, std::void_t<decltype(std::declval<T>().getStructInfo())>> = true;
 
+/**
+ * @brief determine at compile time if a type T is a std::vector
+ *
+ * default is false
+ *
+ * @tparam T
+ */
+template <typename T> constexpr bool is_vector{};
+
+/**
+ * @brief specialization for std::vector
+ *
+ * @tparam T
+ */
+template <typename T, typename A> constexpr bool is_vector<std::vector<T, A>> = true;
+
+/**
+ * @brief determine at compile time if a type T has a getVariantInfo method.
+ *
+ * default is false
+ *
+ * @tparam T
+ * @tparam typename
+ */
+template <typename T, typename = void> constexpr bool has_getVariantInfo{};
+
+/**
+ * @brief specialization for types that do have getVariantInfo method
+ *
+ * @tparam T
+ */
+template <typename T>
+constexpr bool has_getVariantInfo<T, std::void_t<decltype(std::declval<T>().getVariantInfo())>> = true;
+
+/**
+ * @brief determine at compile time if a type T is a std::vector of structs
+ * or struct variants
+ *
+ * @tparam T
+ */
+template <typename T> constexpr bool is_composite_vector{};
+
+/**
+ * @brief specialization for std::vector
+ *
+ * @tparam T
+ */
+template <typename T, typename A>
+constexpr bool is_composite_vector<std::vector<T, A>> = has_getStructInfo<T> || has_getVariantInfo<T>;
+
+/**
+ * @brief true for the types whose protobuf conversions are generated from
+ * their StructInfo or VariantInfo rather than specialized by hand
+ *
+ * @tparam T
+ */
+template <typename T>
+constexpr bool is_composite = has_getStructInfo<T> || has_getVariantInfo<T> || is_composite_vector<T>;
+
+/**
+ * @brief the std::variant a generated variant type is derived from
+ */
+template <typename... Ts> std::variant<Ts...> variant_base(const std::variant<Ts...>&);
+
+/**
+ * @brief the std::variant a generated variant type is derived from
+ *
+ * @tparam T
+ */
+template <typename T> using variant_base_t = decltype(variant_base(std::declval<const T&>()));
+
 }  // namespace meta
 
 namespace lite {
 
 /**
- * Free standing method to stream structured data to protobuf
- * 
- * enabled if T has a getStructInfo method
- * 
- * @tparam T the type of the value
+ * Free standing method to stream structured data to a protobuf struct
+ *
+ * @tparam T the type of the struct, which must have a getStructInfo method
+ * @param dst the struct value to serialize to, its existing fields are reused
+ * @param src the struct to serialize
  */
 template <typename T>
-typename std::enable_if<meta::has_getStructInfo<T>, void>::type toProto(catena::Value& dst, const void* src) {
+void structToProto(catena::StructValue& dst, const T& src) {
     const auto& si = T::getStructInfo();
 
     // required so that pointer math works correctly
-    const char* src_ptr = reinterpret_cast<const char*>(src);
+    const char* src_ptr = reinterpret_cast<const char*>(&src);
 
     // serialize each field
+    ::google::protobuf::Map<std::string, ::catena::StructField>& dstFields = *dst.mutable_fields();
     for (const auto& field : si.fields) {
-        ::catena::StructValue* structValue = dst.mutable_struct_value();
-        ::google::protobuf::Map<std::string, ::catena::StructField>* dstFields = structValue->mutable_fields();
-        auto& dstField = (*dstFields)[field.name];
-        auto& dstValue = *dstField.mutable_value();
+        auto& dstValue = *dstFields[field.name].mutable_value();
         field.toProto(dstValue, src_ptr + field.offset);
     }
 }
 
+/**
+ * Free standing method to stream a protobuf struct to structured data
+ *
+ * @tparam T the type of the struct, which must have a getStructInfo method
+ * @param dst the struct to deserialize to
+ * @param src the struct value to deserialize from
+ * @throws catena::exception_with_status if src is missing one of the struct's fields
+ */
+template <typename T>
+void structFromProto(T& dst, const catena::StructValue& src) {
+    const auto& si = T::getStructInfo();
+
+    // required so that pointer math works correctly
+    char* dst_ptr = reinterpret_cast<char*>(&dst);
+
+    // deserialize each field
+    const ::google::protobuf::Map<std::string, ::catena::StructField>& srcFields = src.fields();
+    for (const auto& field : si.fields) {
+        auto it = srcFields.find(field.name);
+        if (it == srcFields.end()) {
+            std::stringstream why;
+            why << __PRETTY_FUNCTION__ << "\nfield '" << field.name << "' of '" << si.name << "' is missing";
+            throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
+        }
+        field.fromProto(dst_ptr + field.offset, it->second.value());
+    }
+}
+
+/**
+ * Free standing method to stream a struct variant to protobuf
+ *
+ * @tparam T the type of the variant, which must have a getVariantInfo method
+ * @param dst the struct variant value to serialize to
+ * @param src the variant to serialize
+ * @throws catena::exception_with_status if src is valueless by exception
+ */
+template <typename T>
+void variantToProto(catena::StructVariantValue& dst, const T& src);
+
+/**
+ * Free standing method to stream a protobuf struct variant to a variant
+ *
+ * If src holds the alternative that's already active, it is assigned in
+ * place so that the storage it owns is reused.
+ *
+ * @tparam T the type of the variant, which must have a getVariantInfo method
+ * @param dst the variant to deserialize to
+ * @param src the struct variant value to deserialize from
+ * @throws catena::exception_with_status if src names an unknown alternative
+ */
+template <typename T>
+void variantFromProto(T& dst, const catena::StructVariantValue& src);
+
+/**
+ * Free standing method to stream structured data to protobuf
+ * 
+ * enabled if T has a getStructInfo method
+ * 
+ * @tparam T the type of the value
+ */
+template <typename T>
+typename std::enable_if<meta::has_getStructInfo<T>, void>::type toProto(catena::Value& dst, const void* src) {
+    structToProto<T>(*dst.mutable_struct_value(), *reinterpret_cast<const T*>(src));
+}
+
+/**
+ * Free standing method to stream a struct variant to protobuf
+ * 
+ * enabled if T has a getVariantInfo method
+ * 
+ * @tparam T the type of the value
+ */
+template <typename T>
+typename std::enable_if<meta::has_getVariantInfo<T>, void>::type toProto(catena::Value& dst, const void* src) {
+    variantToProto<T>(*dst.mutable_struct_variant_value(), *reinterpret_cast<const T*>(src));
+}
+
+/**
+ * Free standing method to stream an array of structs or struct variants
+ * to protobuf
+ *
+ * The elements already held by dst are recycled.
+ * 
+ * @tparam T the type of the value, a std::vector
+ */
+template <typename T>
+typename std::enable_if<meta::is_composite_vector<T>, void>::type toProto(catena::Value& dst, const void* src) {
+    using E = typename T::value_type;
+    const auto& vec = *reinterpret_cast<const T*>(src);
+    if constexpr (meta::has_getStructInfo<E>) {
+        auto& values = *dst.mutable_struct_array_values()->mutable_struct_values();
+        values.Clear();
+        values.Reserve(static_cast<int>(vec.size()));
+        for (const auto& element : vec) {
+            structToProto<E>(*values.Add(), element);
+        }
+    } else {
+        auto& values = *dst.mutable_struct_variant_array_values()->mutable_struct_variants();
+        values.Clear();
+        values.Reserve(static_cast<int>(vec.size()));
+        for (const auto& element : vec) {
+            variantToProto<E>(*values.Add(), element);
+        }
+    }
+}
 
 template <typename T>
-typename std::enable_if<!meta::has_getStructInfo<T>, void>::type toProto(catena::Value& dst, const void* src);
+typename std::enable_if<!meta::is_composite<T>, void>::type toProto(catena::Value& dst, const void* src);
 
 
 /**
@@ -117,23 +321,110 @@ typename std::enable_if<!meta::has_getStructInfo<T>, void>::type toProto(catena:
  */
 template <typename T>
 typename std::enable_if<meta::has_getStructInfo<T>, void>::type fromProto(void* dst, const catena::Value& src) {
-    const auto& si = T::getStructInfo();
+    structFromProto<T>(*reinterpret_cast<T*>(dst), src.struct_value());
+}
 
-    // required so that pointer math works correctly
-    char* dst_ptr = reinterpret_cast<char*>(dst);
+/**
+ * Free standing method to stream protobuf to a struct variant
+ * 
+ * enabled if T has a getVariantInfo method
+ * 
+ * @tparam T the type of the value
+ */
+template <typename T>
+typename std::enable_if<meta::has_getVariantInfo<T>, void>::type fromProto(void* dst, const catena::Value& src) {
+    variantFromProto<T>(*reinterpret_cast<T*>(dst), src.struct_variant_value());
+}
 
-    // deserialize each field
-    for (const auto& field : si.fields) {
-        const ::catena::StructValue& structValue = src.struct_value();
-        const ::google::protobuf::Map<std::string, ::catena::StructField>& srcFields = structValue.fields();
-        const auto& srcField = srcFields.at(field.name);
-        const auto& srcValue = srcField.value();
-        field.fromProto(dst_ptr + field.offset, srcValue);
+/**
+ * Free standing method to stream protobuf to an array of structs or struct
+ * variants
+ *
+ * The elements are stored contiguously and those already present are
+ * assigned in place.
+ * 
+ * @tparam T the type of the value, a std::vector
+ */
+template <typename T>
+typename std::enable_if<meta::is_composite_vector<T>, void>::type fromProto(void* dst, const catena::Value& src) {
+    using E = typename T::value_type;
+    auto& vec = *reinterpret_cast<T*>(dst);
+    if constexpr (meta::has_getStructInfo<E>) {
+        const auto& values = src.struct_array_values().struct_values();
+        vec.resize(values.size());
+        for (int i = 0; i < values.size(); ++i) {
+            structFromProto<E>(vec[i], values.Get(i));
+        }
+    } else {
+        const auto& values = src.struct_variant_array_values().struct_variants();
+        vec.resize(values.size());
+        for (int i = 0; i < values.size(); ++i) {
+            variantFromProto<E>(vec[i], values.Get(i));
+        }
     }
 }
 
 template <typename T>
-typename std::enable_if<!meta::has_getStructInfo<T>, void>::type fromProto(void* dst, const catena::Value& src);
+typename std::enable_if<!meta::is_composite<T>, void>::type fromProto(void* dst, const catena::Value& src);
+
+namespace detail {
+/**
+ * @brief serialize alternative I of variant T
+ */
+template <typename T, std::size_t I>
+void alternativeToProto(catena::Value& dst, const T& src) {
+    toProto<std::variant_alternative_t<I, meta::variant_base_t<T>>>(dst, &std::get<I>(src));
+}
+
+/**
+ * @brief deserialize into alternative I of variant T, making it the active one
+ */
+template <typename T, std::size_t I>
+void alternativeFromProto(T& dst, const catena::Value& src) {
+    using A = std::variant_alternative_t<I, meta::variant_base_t<T>>;
+    A* alternative = dst.index() == I ? &std::get<I>(dst) : &dst.template emplace<I>();
+    fromProto<A>(alternative, src);
+}
+
+/**
+ * @brief tables of the conversions of each of T's alternatives, indexed like the variant
+ */
+template <typename T, typename = std::make_index_sequence<std::variant_size_v<meta::variant_base_t<T>>>>
+struct AlternativeTable;
+
+template <typename T, std::size_t... I>
+struct AlternativeTable<T, std::index_sequence<I...>> {
+    static constexpr void (*toProto[])(catena::Value&, const T&) = {&alternativeToProto<T, I>...};
+    static constexpr void (*fromProto[])(T&, const catena::Value&) = {&alternativeFromProto<T, I>...};
+};
+}  // namespace detail
+
+template <typename T>
+void variantToProto(catena::StructVariantValue& dst, const T& src) {
+    const auto& vi = T::getVariantInfo();
+    if (src.valueless_by_exception()) {
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\n'" << vi.name << "' holds no alternative";
+        throw catena::exception_with_status(why.str(), catena::StatusCode::FAILED_PRECONDITION);
+    }
+    const std::size_t index = src.index();
+    dst.set_struct_variant_type(vi.alternatives[index].data(), vi.alternatives[index].size());
+    detail::AlternativeTable<T>::toProto[index](*dst.mutable_value(), src);
+}
+
+template <typename T>
+void variantFromProto(T& dst, const catena::StructVariantValue& src) {
+    const auto& vi = T::getVariantInfo();
+    for (std::size_t i = 0; i < vi.alternatives.size(); ++i) {
+        if (vi.alternatives[i] == src.struct_variant_type()) {
+            detail::AlternativeTable<T>::fromProto[i](dst, src.value());
+            return;
+        }
+    }
+    std::stringstream why;
+    why << __PRETTY_FUNCTION__ << "\n'" << src.struct_variant_type() << "' is not an alternative of '" << vi.name << "'";
+    throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
+}
 
 }  // namespace lite
 }  // namespace catena
@@ -0,0 +1,180 @@
+#pragma once
+
+/**
+ * @file WriteAheadLog.h
+ * @brief Optional persistence stage that journals client value changes to disk
+ * @copyright Copyright (c) 2024 Ross Video
+ */
+
+#include <lite/include/Device.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace catena {
+namespace lite {
+
+class IParam;  // forward reference
+
+/**
+ * @brief Journals every value set by a client so that the device can be
+ * restored to its last acknowledged state after a restart.
+ *
+ * The log listens to Device::valueSetByClient. The listener only pushes the
+ * changed param onto a lock-free queue, so the cost added to the SetValue
+ * path is one small allocation and one compare-and-swap.
+ *
+ * A writer thread drains the queue, copies the current value of each changed
+ * param with the device locked, and appends them to the log file. A value
+ * copied this way is at least as new as the one that was set, and a param
+ * changed several times in a batch is logged once. It group-commits, making
+ * one write and one fsync per batch. A batch is committed when
+ * commitInterval has elapsed or when commitRecords are pending, whichever
+ * comes first. Once the log grows beyond compactBytes it is folded into a
+ * snapshot holding the latest value of each logged param, and the log is
+ * truncated.
+ *
+ * On construction the snapshot and then the log are replayed into the
+ * device. A torn record at the tail of the log, left by a crash mid-write,
+ * ends the replay and is truncated away.
+ */
+class WriteAheadLog {
+  public:
+    /**
+     * @brief tuning knobs for group commit and compaction
+     */
+    struct Options {
+        std::chrono::milliseconds commitInterval;  ///< longest a record waits to be committed
+        std::size_t commitRecords;                  ///< pending records that force an early commit
+        std::size_t compactBytes;                   ///< log size that triggers a snapshot
+    };
+
+    /**
+     * @brief the options used when none are supplied
+     * @return 10ms commit interval, 1024 records per commit, 4MiB log before compaction
+     */
+    static Options defaultOptions();
+
+  public:
+    /**
+     * @brief replay any saved state into the device, then start journalling
+     * @param dm the device to journal
+     * @param dir directory holding the log and snapshot files, created if absent
+     * @param options group commit and compaction settings
+     * @throws catena::exception_with_status if the files cannot be opened
+     */
+    WriteAheadLog(Device& dm, const std::filesystem::path& dir, const Options& options);
+
+    /**
+     * @brief replay any saved state into the device, then start journalling
+     * using the default options
+     * @param dm the device to journal
+     * @param dir directory holding the log and snapshot files, created if absent
+     */
+    WriteAheadLog(Device& dm, const std::filesystem::path& dir);
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief stop listening, commit whatever is pending and close the log
+     * @note the writer locks the device to copy values, so don't destroy the
+     * log with the device locked
+     */
+    virtual ~WriteAheadLog();
+
+    /**
+     * @brief block until every record queued before the call is durable
+     * @note don't call with the device locked, see ~WriteAheadLog
+     */
+    void sync();
+
+    /**
+     * @brief number of records applied to the device during replay
+     */
+    inline std::size_t replayed() const { return replayed_; }
+
+  private:
+    /**
+     * @brief node of the lock-free multi-producer queue of pending records
+     */
+    struct Record {
+        Record* next;
+        const IParam* param;  ///< the changed param, owned by the device
+    };
+
+    /**
+     * @brief slot connected to Device::valueSetByClient
+     */
+    void enqueue_(const IParam* param);
+
+    /**
+     * @brief body of the writer thread
+     */
+    void run_();
+
+    /**
+     * @brief write and fsync every pending record as one batch
+     */
+    void commit_();
+
+    /**
+     * @brief append a batch of framed records to the log and flush it to disk
+     *
+     * If the batch can't be written in full, the log is cut back to where it
+     * was, so walBytes_ only counts intact records.
+     *
+     * @param batch the framed records
+     * @return true if the whole batch was written
+     */
+    bool append_(const std::string& batch);
+
+    /**
+     * @brief fold the latest values into a new snapshot and truncate the log
+     */
+    void compact_();
+
+    /**
+     * @brief apply the records in file to the device
+     * @param file the snapshot or log file to replay
+     * @param truncateTorn if true, cut the file back to its last intact record
+     */
+    void replay_(const std::filesystem::path& file, bool truncateTorn);
+
+    Device& dm_;
+    Options options_;
+    std::filesystem::path walPath_;
+    std::filesystem::path snapshotPath_;
+    std::FILE* wal_;        /**< the log, null if it couldn't be reopened after a failed write */
+    std::size_t walBytes_;  /**< size of the log's intact records */
+    std::size_t replayed_;
+
+    /**
+     * @brief latest framed record of each param, the contents of the next snapshot
+     * @note only touched by the writer thread once construction completes
+     */
+    std::unordered_map<std::string, std::string> latest_;
+
+    std::atomic<Record*> pending_;
+    std::atomic<std::size_t> pendingRecords_;
+    std::atomic<uint64_t> enqueued_;
+    uint64_t durable_;
+    bool stopping_;
+    bool syncRequested_;
+    std::mutex mutex_;
+    std::condition_variable commitCv_;
+    std::condition_variable durableCv_;
+    std::thread writer_;
+    unsigned int valueSetByClientId_;
+};
+
+}  // namespace lite
+}  // namespace catena
@@ -1,6 +1,6 @@
 #include <lite/include/Device.h>
 #include <lite/include/IParam.h>
-
+#include <common/include/InlineVector.h>
 
 #include <cassert>
 
@@ -10,21 +10,102 @@ using namespace catena::common;
 void Device::toProto(::catena::Device& dst, bool shallow) const {
     dst.set_slot(slot_);
     dst.set_detail_level(detail_level_);
+    dst.clear_access_scopes();
+    for (const auto& scope : access_scopes_) {
+        dst.add_access_scopes(Scopes(scope).toString());
+    }
     *dst.mutable_default_scope() = default_scope_.toString();
     dst.set_multi_set_enabled(multi_set_enabled_);
     dst.set_subscriptions(subscriptions_);
     if (shallow) { return; }
 
     // if we're not doing a shallow copy, we need to copy all the Items
-    /// @todo: implement deep copies for constraints, menu groups, commands, etc...
-    // for now, we can make do with just params
-    google::protobuf::Map<std::string, ::catena::Param> dstParams{};
-    for (const auto& [name, param] : params_) {
-        ::catena::Param dstParam{};
-        param->toProto(dstParam);
-        dstParams[name] = dstParam;
-    }
-    dst.mutable_params()->swap(dstParams);
+    auto& dstConstraints = *dst.mutable_constraints();
+    dstConstraints.clear();
+    for (const auto& [name, constraint] : constraints_) {
+        constraint->toProto(dstConstraints[name.str()]);
+    }
+
+    // params and commands refer to their shared constraints by oid, so make
+    // sure each one they use is serialized, once, even if it wasn't registered
+    auto addSharedConstraint = [&dstConstraints](const IParam* param) {
+        const IConstraint* constraint = param->getConstraint();
+        if (constraint != nullptr && constraint->getShared() && !dstConstraints.contains(constraint->getOid())) {
+            constraint->toProto(dstConstraints[constraint->getOid()]);
+        }
+    };
+
+    auto& dstParams = *dst.mutable_params();
+    dstParams.clear();
+    if (params_serializer_.serialize != nullptr && params_serializer_.count == params_.size()) {
+        // the generated serializer's shared constraints were all registered
+        // with the device, so they've been serialized already
+        params_serializer_.serialize(dstParams);
+    } else {
+        for (const auto& [name, param] : params_) {
+            param->toProto(dstParams[name.str()]);
+            addSharedConstraint(param);
+        }
+    }
+
+    auto& dstCommands = *dst.mutable_commands();
+    dstCommands.clear();
+    for (const auto& [name, command] : commands_) {
+        command->toProto(dstCommands[name.str()]);
+        addSharedConstraint(command);
+    }
+
+    auto& dstMenuGroups = *dst.mutable_menu_groups();
+    dstMenuGroups.clear();
+    for (const auto& [name, menuGroup] : menu_groups_) {
+        menuGroup->toProto(dstMenuGroups[name.str()]);
+    }
+
+    auto& dstPacks = *dst.mutable_language_packs()->mutable_packs();
+    dstPacks.clear();
+    for (const auto& [name, pack] : language_packs_) {
+        pack->toProto(dstPacks[name.str()]);
+    }
 }
 
+Device::ValueSetSignal& Device::subtreeSignal_(SubtreeSignals& subtrees, const std::string& oid) {
+    {
+        std::shared_lock lock(subtrees.mutex);
+        auto it = subtrees.signals.find(oid);
+        if (it != subtrees.signals.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock lock(subtrees.mutex);
+    auto& signal = subtrees.signals[oid];
+    if (!signal) {
+        signal = std::make_unique<ValueSetSignal>();
+    }
+    return *signal;
+}
 
+void Device::emitSubtree_(const SubtreeSignals& subtrees, const std::string& oid, const IParam* param, int32_t idx) {
+    // the signals are found with the lock held and emitted once it's
+    // released, so that listeners can add signals of their own. Signals are
+    // never removed, so the pointers stay valid.
+    InlineVector<ValueSetSignal*, 8> matched;
+    {
+        std::shared_lock lock(subtrees.mutex);
+        if (subtrees.signals.empty()) {
+            return;
+        }
+        // "/a/b/c" notifies the listeners of "/a/b/c", then "/a/b", then "/a"
+        std::string_view subtree{oid};
+        while (!subtree.empty()) {
+            auto it = subtrees.signals.find(subtree);
+            if (it != subtrees.signals.end()) {
+                matched.push_back(it->second.get());
+            }
+            auto slash = subtree.rfind('/');
+            subtree = subtree.substr(0, slash == std::string_view::npos ? 0 : slash);
+        }
+    }
+    for (std::size_t i = 0; i < matched.size(); ++i) {
+        matched[i]->emit(oid, param, idx);
+    }
+}
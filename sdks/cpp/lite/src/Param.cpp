@@ -2,10 +2,13 @@
 
 #include <lite/include/Param.h>
 #include <lite/include/StructInfo.h>
+#include <lite/include/Blob.h>
+#include <common/include/Status.h>
 
 #include <vector>
 #include <string>
 #include <type_traits>
+#include <sstream>
 
 
 using catena::Value;
@@ -13,6 +16,7 @@ using catena::lite::Param;
 using catena::meta::has_getStructInfo;
 using catena::lite::StructInfo;
 using catena::lite::FieldInfo;
+using catena::lite::Blob;
 
 template <>
 void Param<int32_t>::toProto(Value& dst) const {
@@ -20,7 +24,7 @@ void Param<int32_t>::toProto(Value& dst) const {
 }
 
 template <>
-void Param<int32_t>::fromProto(Value& src) {
+void Param<int32_t>::assign_(Value& src) {
     if (constraint_) {
         constraint_->apply(&src);
     }
@@ -33,7 +37,7 @@ void Param<std::string>::toProto(Value& dst) const {
 }
 
 template <>
-void Param<std::string>::fromProto(Value& src) {
+void Param<std::string>::assign_(Value& src) {
     if (constraint_) {
         constraint_->apply(&src);
     }
@@ -46,7 +50,7 @@ void Param<float>::toProto(Value& dst) const {
 }
 
 template <>
-void Param<float>::fromProto(Value& src) {
+void Param<float>::assign_(Value& src) {
     if (constraint_) {
         constraint_->apply(&src);
     }
@@ -59,7 +63,7 @@ void Param<std::vector<std::string>>::toProto(Value& dst) const {
 }
 
 template <>
-void Param<std::vector<std::string>>::fromProto(Value& src) {
+void Param<std::vector<std::string>>::assign_(Value& src) {
     catena::lite::fromProto<std::vector<std::string>>(&value_.get(), src);
 }
 
@@ -69,7 +73,10 @@ void Param<std::vector<std::int32_t>>::toProto(Value& dst) const {
 }
 
 template <>
-void Param<std::vector<std::int32_t>>::fromProto(Value& src) {
+void Param<std::vector<std::int32_t>>::assign_(Value& src) {
+    if (constraint_) {
+        constraint_->apply(&src);
+    }
     catena::lite::fromProto<std::vector<std::int32_t>>(&value_.get(), src);
 }
 
@@ -79,9 +86,28 @@ void Param<std::vector<float>>::toProto(Value& dst) const {
 }
 
 template <>
-void Param<std::vector<float>>::fromProto(Value& src) {
+void Param<std::vector<float>>::assign_(Value& src) {
+    if (constraint_) {
+        constraint_->apply(&src);
+    }
     catena::lite::fromProto<std::vector<float>>(&value_.get(), src);
 }
 
+template <>
+void Param<Blob>::toProto(Value& dst) const {
+    // the outgoing message owns its bytes, so the payload is copied into it,
+    // once per message. The reference keeps it alive while it's copied.
+    Blob::Payload payload = value_.get().load();
+    *dst.mutable_data_payload() = *payload;
+}
 
-
+template <>
+void Param<Blob>::assign_(Value& src) {
+    if (!src.has_data_payload()) {
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\nexpected a data payload for '" << getOid() << "'";
+        throw catena::exception_with_status(why.str(), catena::StatusCode::INVALID_ARGUMENT);
+    }
+    // the payload is moved out of the request rather than copied
+    value_.get().store(std::move(*src.mutable_data_payload()));
+}
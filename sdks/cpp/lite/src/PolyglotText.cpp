@@ -1,16 +1,63 @@
 #include <PolyglotText.h>
 
+#include <functional>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace catena {
 namespace lite {
+namespace {
+/**
+ * @brief hashes display strings regardless of the order they're stored in
+ */
+struct DisplayStringsHash {
+    std::size_t operator()(const PolyglotText::DisplayStrings& display_strings) const {
+        std::hash<std::string> hash;
+        std::size_t ans = display_strings.size();
+        for (const auto& [lang, text] : display_strings) {
+            ans += hash(lang) ^ (hash(text) * 31);
+        }
+        return ans;
+    }
+};
+
+/**
+ * @brief the pool of display strings shared by every PolyglotText. The set's
+ * elements don't move as it grows, so the references handed out stay valid.
+ */
+struct Pool {
+    std::unordered_set<PolyglotText::DisplayStrings, DisplayStringsHash> texts;
+    std::mutex mtx;
+};
+
+Pool& pool() {
+    // never destroyed, so texts in static objects outlive it safely
+    static Pool* pool = new Pool;
+    return *pool;
+}
+}  // namespace
+
+const PolyglotText::DisplayStrings& PolyglotText::intern_(DisplayStrings&& display_strings) {
+    Pool& p = pool();
+    std::lock_guard lock(p.mtx);
+    return *p.texts.insert(std::move(display_strings)).first;
+}
+
+std::size_t PolyglotText::poolSize() {
+    Pool& p = pool();
+    std::lock_guard lock(p.mtx);
+    return p.texts.size();
+}
+
 void PolyglotText::toProto(google::protobuf::MessageLite& m) const {
     auto& dst = dynamic_cast<catena::PolyglotText&>(m);
-    dst.clear_display_strings();
-    for (const auto& [key, value] : display_strings_) {
-        dst.mutable_display_strings()->insert({key, value});
+    auto& dstStrings = *dst.mutable_display_strings();
+    dstStrings.clear();
+    for (const auto& [key, value] : *display_strings_) {
+        dstStrings[key] = value;
     }
 }
 }  // namespace lite
-}  // namespace catena
\ No newline at end of file
+}  // namespace catena
@@ -2,6 +2,8 @@
 
 #include <lite/param.pb.h>
 
+#include <cstring>
+
 
 template<>
 void catena::lite::toProto<float>(catena::Value& dst, const void* src) {
@@ -33,62 +35,72 @@ void catena::lite::fromProto<std::string>(void* dst, const catena::Value& src) {
     *reinterpret_cast<std::string*>(dst) = src.string_value();
 }
 
+// The array conversions reuse the storage already held by their destinations,
+// so repeatedly serializing a param into the same message doesn't allocate.
+// Arrays of numbers are copied in bulk rather than one element at a time.
+
 template<>
 void catena::lite::toProto<std::vector<std::string>>(Value& dst, const void* src) {
-    dst.clear_string_array_values();
-    auto& string_array = *dst.mutable_string_array_values();
     const auto& vec = *reinterpret_cast<const std::vector<std::string>*>(src);
+    auto& strings = *dst.mutable_string_array_values()->mutable_strings();
+    // cleared elements are kept by the repeated field and recycled by Add
+    strings.Clear();
+    strings.Reserve(static_cast<int>(vec.size()));
     for (const auto& s : vec) {
-        string_array.add_strings(s);
+        strings.Add()->assign(s);
     }
 }
 
 template<>
 void catena::lite::fromProto<std::vector<std::string>>(void* dst, const Value& src) {
     auto* vec = reinterpret_cast<std::vector<std::string>*>(dst);
-    vec->clear();
-    const auto& string_array = src.string_array_values();
-    for (int i = 0; i < string_array.strings_size(); ++i) {
-        vec->push_back(string_array.strings(i));
+    const auto& strings = src.string_array_values().strings();
+    vec->resize(strings.size());
+    for (int i = 0; i < strings.size(); ++i) {
+        (*vec)[i].assign(strings.Get(i));
     }
 }
 
 template<>
 void catena::lite::toProto<std::vector<int32_t>>(Value& dst, const void* src) {
-    dst.clear_int32_array_values();
-    auto& int_array = *dst.mutable_int32_array_values();
     const auto& vec = *reinterpret_cast<const std::vector<int32_t>*>(src);
-    for (const auto& i : vec) {
-        int_array.add_ints(i);
+    auto& ints = *dst.mutable_int32_array_values()->mutable_ints();
+    const int n = static_cast<int>(vec.size());
+    ints.Clear();
+    ints.Reserve(n);
+    if (n > 0) {
+        std::memcpy(ints.AddNAlreadyReserved(n), vec.data(), n * sizeof(int32_t));
     }
 }
 
 template<>
 void catena::lite::fromProto<std::vector<int32_t>>(void* dst, const Value& src) {
     auto* vec = reinterpret_cast<std::vector<int32_t>*>(dst);
-    vec->clear();
-    const auto& int_array = src.int32_array_values();
-    for (int i = 0; i < int_array.ints_size(); ++i) {
-        vec->push_back(int_array.ints(i));
+    const auto& ints = src.int32_array_values().ints();
+    vec->resize(ints.size());
+    if (!ints.empty()) {
+        std::memcpy(vec->data(), ints.data(), ints.size() * sizeof(int32_t));
     }
 }
 
 template<>
 void catena::lite::toProto<std::vector<float>>(Value& dst, const void* src) {
-    dst.clear_float32_array_values();
-    auto& float_array = *dst.mutable_float32_array_values();
     const auto& vec = *reinterpret_cast<const std::vector<float>*>(src);
-    for (const auto& f : vec) {
-        float_array.add_floats(f);
+    auto& floats = *dst.mutable_float32_array_values()->mutable_floats();
+    const int n = static_cast<int>(vec.size());
+    floats.Clear();
+    floats.Reserve(n);
+    if (n > 0) {
+        std::memcpy(floats.AddNAlreadyReserved(n), vec.data(), n * sizeof(float));
     }
 }
 
 template<>
 void catena::lite::fromProto<std::vector<float>>(void* dst, const Value& src) {
     auto* vec = reinterpret_cast<std::vector<float>*>(dst);
-    vec->clear();
-    const auto& float_array = src.float32_array_values();
-    for (int i = 0; i < float_array.floats_size(); ++i) {
-        vec->push_back(float_array.floats(i));
+    const auto& floats = src.float32_array_values().floats();
+    vec->resize(floats.size());
+    if (!floats.empty()) {
+        std::memcpy(vec->data(), floats.data(), floats.size() * sizeof(float));
     }
 }
@@ -0,0 +1,341 @@
+#include <lite/include/WriteAheadLog.h>
+#include <lite/include/IParam.h>
+
+#include <common/include/Status.h>
+
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using catena::lite::WriteAheadLog;
+
+namespace {
+
+/**
+ * @brief each record is framed by its length and CRC-32, both little-endian
+ */
+constexpr std::size_t kHeaderSize = 8;
+
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 256> kCrcTable = makeCrcTable();
+
+uint32_t crc32(const char* data, std::size_t len) {
+    uint32_t c = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < len; ++i) {
+        c = kCrcTable[(c ^ static_cast<uint8_t>(data[i])) & 0xFFu] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+void putU32(std::string& dst, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        dst.push_back(static_cast<char>((v >> (8 * i)) & 0xFFu));
+    }
+}
+
+uint32_t getU32(const char* src) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+        v |= static_cast<uint32_t>(static_cast<uint8_t>(src[i])) << (8 * i);
+    }
+    return v;
+}
+
+void frame(std::string& dst, const std::string& payload) {
+    dst.reserve(dst.size() + kHeaderSize + payload.size());
+    putU32(dst, static_cast<uint32_t>(payload.size()));
+    putU32(dst, crc32(payload.data(), payload.size()));
+    dst.append(payload);
+}
+
+/**
+ * @brief flush the stdio buffers and force the file's data to stable storage
+ */
+bool syncFile(std::FILE* f) {
+    if (std::fflush(f) != 0) { return false; }
+#if defined(_WIN32)
+    return _commit(_fileno(f)) == 0;
+#elif defined(__APPLE__)
+    return fsync(fileno(f)) == 0;
+#else
+    return fdatasync(fileno(f)) == 0;
+#endif
+}
+
+std::FILE* openOrThrow(const std::filesystem::path& path, const char* mode) {
+    std::FILE* f = std::fopen(path.string().c_str(), mode);
+    if (f == nullptr) {
+        std::stringstream why;
+        why << __PRETTY_FUNCTION__ << "\ncould not open '" << path.string() << "'";
+        throw catena::exception_with_status(why.str(), catena::StatusCode::INTERNAL);
+    }
+    return f;
+}
+
+}  // namespace
+
+WriteAheadLog::Options WriteAheadLog::defaultOptions() {
+    return Options{std::chrono::milliseconds{10}, 1024, 4 * 1024 * 1024};
+}
+
+WriteAheadLog::WriteAheadLog(Device& dm, const std::filesystem::path& dir)
+    : WriteAheadLog(dm, dir, defaultOptions()) {}
+
+WriteAheadLog::WriteAheadLog(Device& dm, const std::filesystem::path& dir, const Options& options)
+    : dm_{dm}, options_{options}, walPath_{dir / "values.wal"}, snapshotPath_{dir / "values.snapshot"},
+      wal_{nullptr}, walBytes_{0}, replayed_{0}, pending_{nullptr}, pendingRecords_{0}, enqueued_{0},
+      durable_{0}, stopping_{false}, syncRequested_{false}, valueSetByClientId_{0} {
+    std::filesystem::create_directories(dir);
+
+    // restore the last acknowledged state before any client can change it
+    replay_(snapshotPath_, false);
+    replay_(walPath_, true);
+
+    wal_ = openOrThrow(walPath_, "ab");
+    writer_ = std::thread(&WriteAheadLog::run_, this);
+    valueSetByClientId_ = dm_.valueSetByClient.connect(
+        [this](const std::string&, const IParam* p, const int32_t) { enqueue_(p); });
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    dm_.valueSetByClient.disconnect(valueSetByClientId_);
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    commitCv_.notify_one();
+    writer_.join();
+    if (wal_ != nullptr) {
+        std::fclose(wal_);
+    }
+}
+
+void WriteAheadLog::enqueue_(const IParam* param) {
+    // called on the SetValue path with the device locked, so only the param
+    // is noted. Copying its value, framing and I/O are left to the writer.
+    Record* r = new Record{nullptr, param};
+    r->next = pending_.load(std::memory_order_relaxed);
+    while (!pending_.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                           std::memory_order_relaxed)) {}
+    enqueued_.fetch_add(1, std::memory_order_release);
+
+    if (pendingRecords_.fetch_add(1, std::memory_order_relaxed) + 1 >= options_.commitRecords) {
+        commitCv_.notify_one();
+    }
+}
+
+void WriteAheadLog::sync() {
+    uint64_t target = enqueued_.load(std::memory_order_acquire);
+    std::unique_lock lock(mutex_);
+    syncRequested_ = true;
+    commitCv_.notify_one();
+    durableCv_.wait(lock, [this, target] { return durable_ >= target || stopping_; });
+}
+
+void WriteAheadLog::run_() {
+    std::unique_lock lock(mutex_);
+    while (!stopping_) {
+        commitCv_.wait_for(lock, options_.commitInterval, [this] {
+            return stopping_ || syncRequested_ ||
+                   pendingRecords_.load(std::memory_order_relaxed) >= options_.commitRecords;
+        });
+        syncRequested_ = false;
+        lock.unlock();
+        commit_();
+        lock.lock();
+    }
+    lock.unlock();
+    commit_();
+}
+
+void WriteAheadLog::commit_() {
+    Record* head = pending_.exchange(nullptr, std::memory_order_acquire);
+    if (head == nullptr) { return; }
+
+    // the queue is a stack, reverse it to restore arrival order
+    Record* ordered = nullptr;
+    while (head != nullptr) {
+        Record* next = head->next;
+        head->next = ordered;
+        ordered = head;
+        head = next;
+    }
+
+    // each param changed in the batch is logged once, in the order of its
+    // first change
+    std::vector<const IParam*> changed;
+    std::unordered_set<const IParam*> seen;
+    uint64_t count = 0;
+    for (Record* r = ordered; r != nullptr; ++count) {
+        if (seen.insert(r->param).second) {
+            changed.push_back(r->param);
+        }
+        Record* next = r->next;
+        delete r;
+        r = next;
+    }
+    pendingRecords_.fetch_sub(count, std::memory_order_relaxed);
+
+    // copy their current values, which are at least as new as the ones that
+    // were queued, holding the device's lock no longer than that takes
+    std::vector<catena::SetValuePayload> payloads(changed.size());
+    {
+        Device::LockGuard lg(dm_);
+        for (std::size_t i = 0; i < changed.size(); ++i) {
+            changed[i]->toProto(*payloads[i].mutable_value());
+        }
+    }
+
+    std::string batch;
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        catena::SetValuePayload& payload = payloads[i];
+        payload.set_slot(dm_.slot());
+        payload.set_oid(changed[i]->getOid());
+        std::string& latest = latest_[payload.oid()];
+        latest.clear();
+        frame(latest, payload.SerializeAsString());
+        batch.append(latest);
+    }
+
+    if (!append_(batch)) {
+        std::cerr << "WriteAheadLog: failed to commit " << count << " records to "
+                  << walPath_.string() << '\n';
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        durable_ += count;
+    }
+    durableCv_.notify_all();
+
+    if (walBytes_ >= options_.compactBytes) {
+        compact_();
+    }
+}
+
+bool WriteAheadLog::append_(const std::string& batch) {
+    if (wal_ == nullptr) {
+        wal_ = std::fopen(walPath_.string().c_str(), "ab");
+        if (wal_ == nullptr) { return false; }
+    }
+    if (std::fwrite(batch.data(), 1, batch.size(), wal_) == batch.size() && syncFile(wal_)) {
+        walBytes_ += batch.size();
+        return true;
+    }
+
+    // cut off whatever part of the batch reached the log, so the next batch
+    // follows its last intact record, and reopen it to drop what the stream
+    // still buffers. The values are still in latest_ for the next snapshot.
+    std::fclose(wal_);
+    std::error_code ec;
+    std::filesystem::resize_file(walPath_, walBytes_, ec);
+    if (ec) {
+        std::cerr << "WriteAheadLog: could not truncate " << walPath_.string() << ": " << ec.message() << '\n';
+    }
+    wal_ = std::fopen(walPath_.string().c_str(), "ab");
+    return false;
+}
+
+void WriteAheadLog::compact_() {
+    std::filesystem::path tmpPath = snapshotPath_;
+    tmpPath += ".tmp";
+    std::FILE* tmp = std::fopen(tmpPath.string().c_str(), "wb");
+    if (tmp == nullptr) {
+        std::cerr << "WriteAheadLog: could not create " << tmpPath.string() << '\n';
+        return;
+    }
+    bool ok = true;
+    for (const auto& [oid, record] : latest_) {
+        ok = ok && std::fwrite(record.data(), 1, record.size(), tmp) == record.size();
+    }
+    ok = syncFile(tmp) && ok;
+    std::fclose(tmp);
+    if (!ok) {
+        std::cerr << "WriteAheadLog: failed to write " << tmpPath.string() << '\n';
+        return;
+    }
+
+    // the snapshot now supersedes the log. A crash before the truncation
+    // only means the log is replayed again on top of an equal snapshot.
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, snapshotPath_, ec);
+    if (ec) {
+        std::cerr << "WriteAheadLog: could not replace snapshot: " << ec.message() << '\n';
+        return;
+    }
+    // the log is open for appending, so once it's cut back to nothing the
+    // next batch is written from its start. If it can't be cut, keep
+    // appending to it; replaying it over the snapshot is harmless.
+    std::filesystem::resize_file(walPath_, 0, ec);
+    if (ec) {
+        std::cerr << "WriteAheadLog: could not truncate " << walPath_.string() << ": " << ec.message() << '\n';
+        return;
+    }
+    walBytes_ = 0;
+}
+
+void WriteAheadLog::replay_(const std::filesystem::path& file, bool truncateTorn) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) { return; }
+    std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    in.close();
+
+    std::size_t offset = 0;
+    while (data.size() - offset >= kHeaderSize) {
+        const char* header = data.data() + offset;
+        std::size_t len = getU32(header);
+        if (data.size() - offset - kHeaderSize < len) { break; }
+        const char* body = header + kHeaderSize;
+        if (crc32(body, len) != getU32(header + 4)) { break; }
+
+        catena::SetValuePayload payload;
+        if (!payload.ParseFromArray(body, static_cast<int>(len))) { break; }
+        latest_[payload.oid()].assign(header, kHeaderSize + len);
+        offset += kHeaderSize + len;
+
+        IParam* param = dm_.getItem(payload.oid(), Device::ParamTag{});
+        if (param == nullptr) {
+            // the model no longer has this param, keep the record but don't apply it
+            continue;
+        }
+        try {
+            Device::LockGuard lg(dm_);
+            param->fromProto(*payload.mutable_value());
+            ++replayed_;
+        } catch (const catena::exception_with_status& why) {
+            std::cerr << "WriteAheadLog: could not restore " << payload.oid() << ": " << why.what() << '\n';
+        }
+    }
+
+    if (offset != data.size()) {
+        std::cerr << "WriteAheadLog: discarding " << data.size() - offset << " torn bytes from "
+                  << file.string() << '\n';
+        if (truncateTorn) {
+            std::filesystem::resize_file(file, offset);
+        }
+    }
+    if (truncateTorn) {
+        walBytes_ = offset;
+    }
+}
@@ -0,0 +1,56 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include <lite/include/NamedChoiceConstraint.h>
+
+#include <string>
+
+TEST(NamedChoiceConstraintTest, StringChoiceIsSerializedAsOne) {
+    NamedChoiceConstraint<std::string> letters{{"A", "B", "C"}, true, "letters", true};
+    catena::Constraint constraint;
+    letters.toProto(constraint);
+    EXPECT_EQ(constraint.type(), catena::Constraint::STRING_CHOICE);
+    ASSERT_EQ(constraint.string_choice().choices_size(), 3);
+    EXPECT_EQ(constraint.string_choice().choices(1), "B");
+    EXPECT_TRUE(constraint.string_choice().strict());
+    EXPECT_FALSE(constraint.has_string_string_choice());
+}
+
+TEST(NamedChoiceConstraintTest, StrictStringChoiceConstrainsToTheFirst) {
+    NamedChoiceConstraint<std::string> letters{{"A", "B", "C"}, true, "letters", true};
+    catena::Value value;
+    value.set_string_value("C");
+    letters.apply(&value);
+    EXPECT_EQ(value.string_value(), "C");
+    value.set_string_value("Z");
+    letters.apply(&value);
+    EXPECT_EQ(value.string_value(), "A");
+
+    NamedChoiceConstraint<std::string> loose{{"A", "B"}, false, "loose", true};
+    value.set_string_value("Z");
+    loose.apply(&value);
+    EXPECT_EQ(value.string_value(), "Z");
+}
+
+TEST(NamedChoiceConstraintTest, NamedStringChoiceIsStillAStringStringChoice) {
+    NamedChoiceConstraint<std::string> named{{{"a", {{"en", "Alpha"}}}, {"b", {{"en", "Bravo"}}}}, true, "named", true};
+    catena::Constraint constraint;
+    named.toProto(constraint);
+    EXPECT_EQ(constraint.type(), catena::Constraint::STRING_STRING_CHOICE);
+    ASSERT_EQ(constraint.string_string_choice().choices_size(), 2);
+    EXPECT_EQ(constraint.string_string_choice().choices(0).value(), "a");
+    EXPECT_EQ(constraint.string_string_choice().choices(0).name().display_strings().at("en"), "Alpha");
+}
@@ -0,0 +1,173 @@
+// Licensed under the Creative Commons Attribution NoDerivatives 4.0
+// International Licensing (CC-BY-ND-4.0);
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at:
+//
+// https://creativecommons.org/licenses/by-nd/4.0/
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include <lite/include/Device.h>
+#include <lite/include/Param.h>
+#include <lite/include/WriteAheadLog.h>
+
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using catena::lite::Device;
+using catena::lite::Param;
+using catena::lite::WriteAheadLog;
+using Scopes_e = catena::common::Scopes_e;
+
+class WriteAheadLogTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        dir = std::filesystem::temp_directory_path() / (std::string("catena_wal_") + info->name());
+        std::filesystem::remove_all(dir);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    /**
+     * @brief set a value as a client would, and notify the listeners
+     */
+    void clientSet(catena::lite::IParam& p, catena::Value v) {
+        Device::LockGuard lg(dm);
+        p.fromProto(v);
+        dm.notifyValueSetByClient(p.getOid(), &p, -1);
+    }
+
+    void clientSet(int32_t v) {
+        catena::Value value;
+        value.set_int32_value(v);
+        clientSet(countParam, value);
+    }
+
+    void clientSet(const std::string& v) {
+        catena::Value value;
+        value.set_string_value(v);
+        clientSet(nameParam, value);
+    }
+
+    std::filesystem::path dir;
+    Device dm{1, catena::Device_DetailLevel_FULL, {Scopes_e::kMonitor}, Scopes_e::kMonitor, true, false};
+    int32_t count{0};
+    Param<int32_t> countParam{catena::ParamType::INT32, count, {}, {{"en", "Count"}}, "", false, nullptr, "/count", dm};
+    std::string name{"initial"};
+    Param<std::string> nameParam{catena::ParamType::STRING, name, {}, {{"en", "Name"}}, "", false, nullptr, "/name", dm};
+};
+
+TEST_F(WriteAheadLogTest, ReplaysLatestValues) {
+    {
+        WriteAheadLog wal(dm, dir);
+        EXPECT_EQ(wal.replayed(), 0u);
+        clientSet(1);
+        clientSet("first");
+        clientSet(2);
+        wal.sync();
+    }
+    count = 0;
+    name = "initial";
+
+    WriteAheadLog wal(dm, dir);
+    EXPECT_EQ(count, 2);
+    EXPECT_EQ(name, "first");
+    EXPECT_GT(wal.replayed(), 0u);
+}
+
+TEST_F(WriteAheadLogTest, TruncatesTornTail) {
+    {
+        WriteAheadLog wal(dm, dir);
+        clientSet(7);
+        wal.sync();
+    }
+    std::filesystem::path log = dir / "values.wal";
+    std::uintmax_t intact = std::filesystem::file_size(log);
+    ASSERT_GT(intact, 0u);
+    {
+        // a header promising more than was written, as a crash mid-write leaves
+        std::ofstream out(log, std::ios::binary | std::ios::app);
+        const char torn[] = {0x40, 0, 0, 0, 0x12, 0x34, 0x56, 0x78, 0x0a, 0x02};
+        out.write(torn, sizeof(torn));
+    }
+    count = 0;
+
+    WriteAheadLog wal(dm, dir);
+    EXPECT_EQ(count, 7);
+    EXPECT_EQ(std::filesystem::file_size(log), intact);
+
+    // and journalling carries on after the intact records
+    clientSet(8);
+    wal.sync();
+    EXPECT_GT(std::filesystem::file_size(log), intact);
+}
+
+TEST_F(WriteAheadLogTest, CompactsIntoSnapshot) {
+    WriteAheadLog::Options options = WriteAheadLog::defaultOptions();
+    options.compactBytes = 1;  // fold the log into the snapshot after every batch
+    {
+        WriteAheadLog wal(dm, dir, options);
+        clientSet(3);
+        wal.sync();
+        clientSet("second");
+        clientSet(4);
+    }
+    EXPECT_EQ(std::filesystem::file_size(dir / "values.wal"), 0u);
+    EXPECT_GT(std::filesystem::file_size(dir / "values.snapshot"), 0u);
+    count = 0;
+    name = "initial";
+
+    WriteAheadLog wal(dm, dir, options);
+    EXPECT_EQ(count, 4);
+    EXPECT_EQ(name, "second");
+    EXPECT_EQ(wal.replayed(), 2u);
+}
+
+#ifndef _WIN32
+TEST_F(WriteAheadLogTest, DropsFailedWrite) {
+    std::filesystem::path log = dir / "values.wal";
+    {
+        WriteAheadLog wal(dm, dir);
+        clientSet(5);
+        wal.sync();
+        std::uintmax_t intact = std::filesystem::file_size(log);
+
+        // let the log grow by only a few bytes, so the next batch is cut short
+        struct rlimit limit;
+        ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &limit), 0);
+        struct rlimit small = limit;
+        small.rlim_cur = intact + 16;
+        auto handler = std::signal(SIGXFSZ, SIG_IGN);
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &small), 0);
+        clientSet(std::string(256, 'x'));
+        wal.sync();
+        setrlimit(RLIMIT_FSIZE, &limit);
+        std::signal(SIGXFSZ, handler);
+        EXPECT_EQ(std::filesystem::file_size(log), intact);
+
+        // and later batches follow the intact records
+        clientSet(6);
+        wal.sync();
+        EXPECT_GT(std::filesystem::file_size(log), intact);
+    }
+    count = 0;
+
+    WriteAheadLog wal(dm, dir);
+    EXPECT_EQ(count, 6);
+}
+#endif
@@ -43,28 +43,112 @@ const getFieldInit = {
 };
 
 function structInit(names, srctypes, desc) {
-    let inits = [];
     if ("value" in desc) {
-        let fields = desc.value.struct_value.fields;
-        for (let i = 0; i < names.length; ++i) {
-            if (names[i] in fields) {
-                let field = fields[names[i]];
-                let srctype = srctypes[i];
-                if (srctype in kCppTypes) {
-                    inits.push(getFieldInit[srctype](field.value));
-                } else {
-                    inits.push('{}');
-                }
+        return structValueInit(names, srctypes, desc.value.struct_value);
+    }
+    // value initialized, so the fields keep their defaults
+    return '{}';
+}
+
+// initializer of a struct from its struct_value in the device model
+function structValueInit(names, srctypes, structValue) {
+    let inits = [];
+    let fields = structValue.fields;
+    for (let i = 0; i < names.length; ++i) {
+        if (names[i] in fields) {
+            let field = fields[names[i]];
+            let srctype = srctypes[i];
+            if (srctype in kCppTypes) {
+                inits.push(getFieldInit[srctype](field.value));
             } else {
                 inits.push('{}');
             }
+        } else {
+            inits.push('{}');
         }
-    } else {
-        inits.push('{}');
     }
     return `{${inits.join(', ')}}`;
 }
 
+// initializer of a struct variant from its struct_variant_value in the device model
+function variantValueInit(info, variantValue) {
+    const i = info.alternatives.indexOf(variantValue.struct_variant_type);
+    if (i < 0) {
+        throw new Error(`${variantValue.struct_variant_type} is not an alternative of ${info.fqname}`);
+    }
+    let init;
+    if (info.srctypes[i] in kCppTypes) {
+        init = getFieldInit[info.srctypes[i]](variantValue.value);
+    } else {
+        const alt = info.structs[i];
+        init = `${alt.fqname}${structValueInit(alt.names, alt.srctypes, variantValue.value.struct_value)}`;
+    }
+    return `${info.fqname}{std::in_place_index<${i}>, ${init}}`;
+}
+
+function polyglotInit(display_strings) {
+    let inits = [];
+    for (let lang in display_strings) {
+        inits.push(`{"${lang}",${quoted(display_strings[lang])}}`);
+    }
+    return `{${inits.join(',')}}`;
+}
+
+// min, max, step, display_min, display_max arguments of RangeConstraint
+function rangeInit(cons) {
+    const step = cons.step !== undefined ? cons.step : (cons.steps !== undefined ? cons.steps : 1);
+    let fields = `${cons.min_value},${cons.max_value},${step}`;
+    fields += cons.display_min !== undefined ? `,${cons.display_min}` : `,${cons.min_value}`;
+    fields += cons.display_max !== undefined ? `,${cons.display_max}` : `,${cons.max_value}`;
+    return fields;
+}
+
+// value and name pairs of NamedChoiceConstraint
+function choicesInit(choices, quote = '') {
+    const inits = choices.map(choice => {
+        const names = choice.name !== undefined ? choice.name.display_strings : {};
+        return `{${quote}${choice.value}${quote},${polyglotInit(names)}}`;
+    });
+    return `{${inits.join(',')}}`;
+}
+
+// desc with the fields it doesn't set filled in from its template, the way
+// the full SDK's DeviceModel fills in templated params. The params of user
+// defined types aren't copied, as their type is the template's.
+function inheritTemplate(desc, template) {
+    let merged = Object.assign({}, desc);
+    for (const flag of ["read_only", "response", "minimal_set", "stateless"]) {
+        if (template[flag]) {
+            merged[flag] = template[flag];
+        }
+    }
+    for (const field of ["precision", "max_length", "widget", "access_scope", "name", "constraint",
+                         "help", "import", "client_hints", "commands", "oid_aliases"]) {
+        if (merged[field] === undefined && template[field] !== undefined) {
+            merged[field] = template[field];
+        }
+    }
+    // an array based off its elements' template keeps its own value
+    if (merged.value === undefined && template.value !== undefined && template.type === desc.type) {
+        merged.value = template.value;
+    }
+    return merged;
+}
+
+// values of a NamedChoiceConstraint whose choices are their own names
+function stringChoicesInit(choices) {
+    if (choices.length === 0) {
+        throw new Error('A string choice constraint needs at least one choice');
+    }
+    return `{${choices.map(quoted).join(',')}}`;
+}
+
+// name of the variable holding the shared constraint with the given oid,
+// which may be written as a json pointer into the device's constraints
+function sharedConstraintName(oid) {
+    return `${oid.replace(/^\/constraints\//, '').replace(/^\//, '')}Constraint`;
+}
+
 class StructConverter {
     constructor (hloc, bloc, namespace) {
         this.hloc = hloc;
@@ -120,124 +204,62 @@ class CppGen {
             return initializer;
         };
         this.namespace = namespace;
+        this.descriptors = new Map();
         this.constraints = {
-            // TODO: shared constraints are not yet supported in the device schema
+            // shared constraints are added to the device and referenced by oid
             "INT_RANGE": (name, desc, indent = 0) => {
+                bloc(`RangeConstraint<int32_t> ${sharedConstraintName(name)}{${rangeInit(desc.int32_range)},"${name}",true,dm};`, indent);
             }, 
             "FLOAT_RANGE": (name, desc, indent = 0) => {
-                // let fields = '';
-                // // FIXME constraint notation type
-                // fields += `${desc.float_range.min_value},${desc.float_range.max_value}`;
-                // bloc(`RangeConstraint<float> ${name}Constraint {${fields}};`, indent);
+                bloc(`RangeConstraint<float> ${sharedConstraintName(name)}{${rangeInit(desc.float_range)},"${name}",true,dm};`, indent);
             }, 
             "INT_CHOICE": (name, desc, indent = 0) => {
+                bloc(`NamedChoiceConstraint<int32_t> ${sharedConstraintName(name)}{${choicesInit(desc.int32_choice.choices)},true,"${name}",true,dm};`, indent);
             },
             "STRING_CHOICE": (name, desc, indent = 0) => {
+                const cons = desc.string_choice;
+                let strict = cons.strict !== undefined ? cons.strict : false;
+                bloc(`NamedChoiceConstraint<std::string> ${sharedConstraintName(name)}{${stringChoicesInit(cons.choices)},${strict},"${name}",true,dm};`, indent);
             },
             "STRING_STRING_CHOICE": (name, desc, indent = 0) => {
-            },
-            "ALARM_TABLE": (name, desc, indent = 0) => {
+                const cons = desc.string_string_choice;
+                let strict = cons.strict !== undefined ? cons.strict : false;
+                bloc(`NamedChoiceConstraint<std::string> ${sharedConstraintName(name)}{${choicesInit(cons.choices, '"')},${strict},"${name}",true,dm};`, indent);
             }
         },
         this.paramConstraints = {
             "INT_RANGE": (name, desc, indent = 0) => {
-                let constraint_name = '';
-                if (desc.constraint.int32_range !== undefined) {
-                    const cons = desc.constraint.int32_range;
-                    constraint_name += `${name}ParamConstraint`;
-                    // collect range bounds
-                    let fields = `${cons.min_value},${cons.max_value}`;
-                    fields += cons.steps !== undefined ? `,${cons.steps}` : ',1';
-                    fields += cons.display_min !== undefined ? `,${cons.display_min}` : `,${cons.min_value}`;
-                    fields += cons.display_max !== undefined ? `,${cons.display_max}` : `,${cons.max_value}`;
-                    bloc(`RangeConstraint<int32_t> ${constraint_name}{${fields},"/param/${name}",false};`, indent);
-                } else {
-                    constraint_name += `${desc.constraint.ref_oid}`;
-                }
-                return `${constraint_name}`;
+                const constraint_name = `${name}ParamConstraint`;
+                bloc(`RangeConstraint<int32_t> ${constraint_name}{${rangeInit(desc.constraint.int32_range)},"/param/${name}",false};`, indent);
+                return constraint_name;
             }, 
             "FLOAT_RANGE": (name, desc, indent = 0) => {
-                let constraint_name = '';
-                if (desc.constraint.float_range !== undefined) {
-                    const cons = desc.constraint.float_range;
-                    constraint_name += `${name}ParamConstraint`;
-                    // collect range bounds
-                    let fields = `${cons.min_value},${cons.max_value}`;
-                    fields += cons.steps !== undefined ? `,${cons.steps}` : ',1';
-                    fields += cons.display_min !== undefined ? `,${cons.display_min}` : `,${cons.min_value}`;
-                    fields += cons.display_max !== undefined ? `,${cons.display_max}` : `,${cons.max_value}`;
-                    bloc(`RangeConstraint<int32_t> ${constraint_name}{${fields},"/param/${name}",false};`, indent);
-                } else {
-                    constraint_name += `${desc.constraint.ref_oid}`;
-                }
-                return `${constraint_name}`;
+                const constraint_name = `${name}ParamConstraint`;
+                bloc(`RangeConstraint<float> ${constraint_name}{${rangeInit(desc.constraint.float_range)},"/param/${name}",false};`, indent);
+                return constraint_name;
             }, 
             "INT_CHOICE": (name, desc, indent = 0) => {
-                let constraint_name = '';
-                if (desc.constraint.int32_choice !== undefined) {
-                    const cons = desc.constraint.int32_choice;
-                    constraint_name += `${name}ParamConstraint`;
-                    let fields = '';
-                    // collect the polyglot names and value pairs
-                    for (let i = 0; i < cons.choices.length; ++i) {
-                        fields += `{${cons.choices[i].value},{`;
-                        let display_strings = cons.choices[i].name.display_strings;
-                        for (let lang in display_strings) {
-                            fields += `{"${lang}",${quoted(display_strings[lang])}}`;
-                            let p = 0;
-                            if (p++ < Object.keys(display_strings).length-1) {
-                                fields += ',';
-                            }
-                        }
-                        fields += '}}';
-                        if (i < cons.choices.length - 1) {
-                            fields += ',';
-                        }
-                    }
-                    let strict = true;
-                    bloc(`NamedChoiceConstraint<int32_t> ${constraint_name}{{${fields}},${strict},"/param/${name}",false};`, indent);
-                } else {
-                    constraint_name += `${desc.constraint.ref_oid}`;
-                }
-                return `${constraint_name}`;
+                const constraint_name = `${name}ParamConstraint`;
+                let strict = true;
+                bloc(`NamedChoiceConstraint<int32_t> ${constraint_name}{${choicesInit(desc.constraint.int32_choice.choices)},${strict},"/param/${name}",false};`, indent);
+                return constraint_name;
             },
             "STRING_STRING_CHOICE": (name, desc, indent = 0) => {
-                let constraint_name = '';
-                if (desc.constraint.int32_choice !== undefined) {
-                    const cons = desc.constraint.int32_choice;
-                    constraint_name += `${name}ParamConstraint`;
-                    let fields = '';
-                    // collect the polyglot names and value pairs
-                    for (let i = 0; i < cons.choices.length; ++i) {
-                        fields += `{${cons.choices[i].value},{`;
-                        let display_strings = cons.choices[i].name.display_strings;
-                        for (let lang in display_strings) {
-                            fields += `{"${lang}",${quoted(display_strings[lang])}}`;
-                            let p = 0;
-                            if (p++ < Object.keys(display_strings).length-1) {
-                                fields += ',';
-                            }
-                        }
-                        fields += '}}';
-                        if (i < cons.choices.length - 1) {
-                            fields += ',';
-                        }
-                    }
-                    let strict = cons.strict !== undefined ? cons.strict : false;
-                    bloc(`NamedChoiceConstraint<std::string> ${constraint_name}{{${fields}},${strict},"/param/${name}",false};`, indent);
-                } else {
-                    constraint_name += `${desc.constraint.ref_oid}`;
-                }
-                return `${constraint_name}`;
+                const constraint_name = `${name}ParamConstraint`;
+                const cons = desc.constraint.string_string_choice;
+                let strict = cons.strict !== undefined ? cons.strict : false;
+                bloc(`NamedChoiceConstraint<std::string> ${constraint_name}{${choicesInit(cons.choices, '"')},${strict},"/param/${name}",false};`, indent);
+                return constraint_name;
             },
             "STRING_CHOICE": (name, desc, indent = 0) => {
-                // FIXME place holder for now
-            },
-            "ALARM_TABLE": (name, desc, indent = 0) => {
-                // FIXME
+                const constraint_name = `${name}ParamConstraint`;
+                const cons = desc.constraint.string_choice;
+                let strict = cons.strict !== undefined ? cons.strict : false;
+                bloc(`NamedChoiceConstraint<std::string> ${constraint_name}{${stringChoicesInit(cons.choices)},${strict},"/param/${name}",false};`, indent);
+                return constraint_name;
             }
         }
-        this.other_items = (name, desc, template) => {
+        this.other_items = (name, desc) => {
             let ans = '';
 
             // add oid_aliases if they exist
@@ -270,8 +292,6 @@ class CppGen {
             if (desc.widget !== undefined) {
                 const widget = desc.widget;
                 widget_init += `${quoted(widget)}`;
-            } else if (template !== undefined && template.widget !== undefined) {
-                widget_init += `${quoted(template.widget)}`;
             } else {
                 widget_init += '""';
             }
@@ -286,105 +306,237 @@ class CppGen {
             
             // construct and add the constraint if it exists
             let constraint_init = '&';
-            if (desc.constraint !== undefined) {
+            if (desc.constraint !== undefined && desc.constraint.ref_oid !== undefined) {
+                constraint_init += sharedConstraintName(desc.constraint.ref_oid);
+            } else if (desc.constraint !== undefined) {
+                if (!(desc.constraint.type in this.paramConstraints)) {
+                    throw new Error(`Constraint of ${name} has unsupported type ${desc.constraint.type}`);
+                }
                 constraint_init += this.paramConstraints[desc.constraint.type](name, desc);
             } else {
                 constraint_init = 'nullptr';
             }
             ans += `${constraint_init}`;
 
+            // remember what the model's serializer needs to write the descriptor
+            this.descriptors.set(name, {
+                aliases: desc.oid_aliases !== undefined ? desc.oid_aliases : [],
+                display_strings: desc.name !== undefined ? desc.name.display_strings : {},
+                widget: widget_init,
+                constraint: constraint_init,
+                shared: desc.constraint !== undefined && desc.constraint.ref_oid !== undefined
+            });
             return ans;
         },
-        this.params = {
-            "STRUCT": (name, desc, template, scope = undefined, indent = 0) => {
-                let params;
-                let classname;
-                if (template === undefined) {
-                    params = desc.params;
-                    classname = initialCap(name);
+        // defines the param named name, of C++ type type, and registers it with the device
+        this.paramDefinition = (name, desc, template, type, paramType, indent = 0) => {
+            bloc(`catena::lite::Param<${type}> ${name}Param(catena::ParamType::${paramType},${name},${this.other_items(name, desc)},"/${name}",dm);`, indent);
+            Object.assign(this.descriptors.get(name), {type, paramType});
+        },
+        // writes the descriptors of the model's params straight from constants,
+        // calling each param's value serializer without virtual dispatch
+        this.paramsSerializer = () => {
+            bloc(`void serializeParams(google::protobuf::Map<std::string, catena::Param>& params) {`);
+            for (const [name, d] of this.descriptors) {
+                bloc(`{`, 1);
+                bloc(`using P = catena::lite::Param<${d.type}>;`, 2);
+                bloc(`catena::Param& dst = params["/${name}"];`, 2);
+                bloc(`dst.set_type(catena::ParamType::${d.paramType});`, 2);
+                for (const alias of d.aliases) {
+                    bloc(`dst.add_oid_aliases(${quoted(alias)});`, 2);
+                }
+                const langs = Object.keys(d.display_strings);
+                if (langs.length > 0) {
+                    bloc(`auto& name = *dst.mutable_name()->mutable_display_strings();`, 2);
+                    for (const lang of langs) {
+                        bloc(`name["${lang}"] = ${quoted(d.display_strings[lang])};`, 2);
+                    }
                 } else {
-                    params = template.params;
-                    classname = initialCap(desc.template_oid.replace(/^\//, ''));
+                    bloc(`dst.mutable_name();`, 2);
                 }
-                if (scope === undefined) {
-                    scope = namespace;
+                bloc(`dst.set_widget(${d.widget});`, 2);
+                bloc(`dst.set_read_only(${name}Param.P::isReadOnly());`, 2);
+                if (d.shared) {
+                    bloc(`dst.mutable_constraint()->set_ref_oid(${d.constraint.slice(1)}.getOid());`, 2);
+                } else if (d.constraint !== 'nullptr') {
+                    bloc(`${d.constraint.slice(1)}.toProto(*dst.mutable_constraint());`, 2);
                 }
-                const fqname = `${scope}::${classname}`;
-                let n = 0;
-                let types = [];
-                let names = [];
-                let srctypes = [];
-                let defaults = [];
-                // gather information about the struct
-                for (let p in params) {
-                    const type = params[p].type;
-                    names.push(p);
-                    srctypes.push(type);
-                    if (type in kCppTypes) {
-                        let cppType = kCppTypes[type];
-                        types.push(cppType);
-                    } else if (type === "STRUCT") {
-                        let userDefinedType = p.charAt(0).toUpperCase() + p.slice(1);
-                        types.push(userDefinedType);
-                        this.params.STRUCT(userDefinedType, params[p], fqname, indent + 1);
-                    }
-                    if ("value" in params[p]) {
-                        defaults.push(`= ${getFieldInit[type](params[p].value)}`);
-                    } else {
-                        defaults.push('{}');
-                    }
-                    // if ("value" in params[p]) {
-                    //     defaults.push(`= ${getFieldInit[type](params[p].value)}`);
-                    // } else {
-                    //     defaults.push('{}');
-                    // }
-                    ++n;
+                bloc(`${name}Param.P::toProto(*dst.mutable_value());`, 2);
+                bloc(`}`, 1);
+            }
+            bloc(`}`);
+        },
+        // defines the struct type with the given params in the header and its
+        // StructInfo in the body. Returns what's needed to initialize it.
+        // With emit false nothing is written, for types that already exist.
+        this.structType = (name, classname, params, scope, indent = 0, emit = true) => {
+            const fqname = `${scope}::${classname}`;
+            let names = [];
+            let types = [];
+            let srctypes = [];
+            let defaults = [];
+            for (let p in params) {
+                const type = params[p].type;
+                names.push(p);
+                srctypes.push(type);
+                // user defined field types are defined ahead of this one
+                types.push(this.fieldType(p, params[p], classname, scope, indent, emit));
+                if ("value" in params[p] && type in getFieldInit) {
+                    defaults.push(`= ${getFieldInit[type](params[p].value)}`);
+                } else {
+                    defaults.push('{}');
                 }
-                
-                if (template === undefined) {
-                    // write the struct to the header file
-                    hloc(`struct ${classname} {`, indent);
-                    for (let i = 0; i < n; ++i) {
-                        hloc(`${types[i]} ${names[i]} ${defaults[i]};`, indent+1);
-                    }
+            }
+            if (emit) {
+                hloc(`struct ${classname} {`, indent);
+                for (let i = 0; i < names.length; ++i) {
+                    hloc(`${types[i]} ${names[i]} ${defaults[i]};`, indent+1);
+                }
+                hloc(`bool operator==(const ${classname}&) const = default;`, indent+1);
+                hloc(`static const catena::lite::StructInfo& getStructInfo();`, indent+1);
+                hloc(`};`, indent);
+
+                // the field table is a compile-time constant
+                bloc(`const StructInfo& ${fqname}::getStructInfo() {`);
+                bloc(`static constexpr FieldInfo fields[] {`, 1);
+                for (let i = 0; i < names.length; ++i) {
+                    bloc(`{ "${names[i]}", offsetof(${fqname}, ${names[i]}), catena::lite::toProto<${types[i]}>, catena::lite::fromProto<${types[i]}> }${i<names.length-1?',':''}`, 2);
+                }
+                bloc(`};`, 1);
+                bloc(`static constexpr StructInfo t {"${name}", fields};`, 1);
+                bloc(`return t;`, 1);
+                bloc('}');
+            }
+            return {fqname, names, srctypes};
+        };
 
-                    // declare the getStructInfo method and typelist in the header file
-                    hloc(`static const catena::lite::StructInfo& getStructInfo();`, indent+1)
-                    hloc(`};`, indent);
+        // defines the variant type with the given alternatives in the header and
+        // its VariantInfo in the body. Struct alternatives are defined ahead of it.
+        this.variantType = (name, classname, params, scope, indent = 0, emit = true) => {
+            const fqname = `${scope}::${classname}`;
+            let alternatives = [];
+            let types = [];
+            let srctypes = [];
+            let structs = [];
+            for (let a in params) {
+                const type = params[a].type;
+                alternatives.push(a);
+                srctypes.push(type);
+                if (type in kCppTypes) {
+                    types.push(kCppTypes[type]);
+                    structs.push(undefined);
+                } else if (type === "STRUCT") {
+                    const alt = this.structType(a, `${classname}${initialCap(a)}`, params[a].params, scope, indent, emit);
+                    types.push(alt.fqname);
+                    structs.push(alt);
+                } else {
+                    throw new Error(`Alternative ${a} of ${name} has unsupported type ${type}`);
                 }
+            }
+            if (emit) {
+                const base = `std::variant<${types.join(', ')}>`;
+                hloc(`struct ${classname} : public ${base} {`, indent);
+                hloc(`using ${base}::variant;`, indent+1);
+                hloc(`static const catena::lite::VariantInfo& getVariantInfo();`, indent+1);
+                hloc(`};`, indent);
+
+                bloc(`const VariantInfo& ${fqname}::getVariantInfo() {`);
+                bloc(`static constexpr std::string_view alternatives[] {${alternatives.map(quoted).join(', ')}};`, 1);
+                bloc(`static constexpr VariantInfo t {"${name}", alternatives};`, 1);
+                bloc(`return t;`, 1);
+                bloc('}');
+            }
+            return {fqname, alternatives, srctypes, structs};
+        };
+
+        // the C++ type of a struct's field. User defined types are named after
+        // the struct and field, and defined first so they're complete when used.
+        this.fieldType = (name, desc, parent, scope, indent, emit) => {
+            const type = desc.type;
+            const classname = `${parent}${initialCap(name)}`;
+            if (type in kCppTypes) {
+                return kCppTypes[type];
+            } else if (type === "STRUCT") {
+                return this.structType(name, classname, desc.params, scope, indent, emit).fqname;
+            } else if (type === "STRUCT_ARRAY") {
+                return `std::vector<${this.structType(name, classname, desc.params, scope, indent, emit).fqname}>`;
+            } else if (type === "STRUCT_VARIANT") {
+                return this.variantType(name, classname, desc.params, scope, indent, emit).fqname;
+            } else if (type === "STRUCT_VARIANT_ARRAY") {
+                return `std::vector<${this.variantType(name, classname, desc.params, scope, indent, emit).fqname}>`;
+            }
+            throw new Error(`Field ${name} has unsupported type ${type}`);
+        };
+
+        // the user defined type of a param. Params based off a template share
+        // the type generated for the template.
+        this.userType = (name, desc, template, defineType) => {
+            if (template === undefined) {
+                return defineType(name, initialCap(name), desc.params, namespace);
+            }
+            const templateName = desc.template_oid.replace(/^\//, '');
+            return defineType(templateName, initialCap(templateName), template.params, namespace, 0, false);
+        };
 
-                // instantiate the struct in the body file 
-                let bodyIndent = 0;
-                bloc(`${fqname} ${name} ${structInit(names, srctypes, desc)};`, bodyIndent);
-                bloc(`catena::lite::Param<${fqname}> ${name}Param(catena::ParamType::STRUCT,${name},${this.other_items(name, desc)},"/${name}",dm);`, bodyIndent)
-                if (template !== undefined) {
-                    // Support functions for user defined types have already been generated
-                    return;
+        // instantiates the value serialization methods of Param<type>, once per type
+        this.specialized = new Set();
+        this.paramSpecializations = (type, indent = 0) => {
+            if (this.specialized.has(type)) {
+                return;
+            }
+            this.specialized.add(type);
+            bloc(`template<>`, indent);
+            bloc(`void catena::lite::Param<${type}>::toProto(catena::Value& value) const {`, indent);
+            bloc(`catena::lite::toProto<${type}>(value, &value_.get());`, indent+1);
+            bloc('}', indent);
+
+            bloc(`template<>`, indent);
+            bloc(`void catena::lite::Param<${type}>::assign_(catena::Value& value) {`, indent);
+            bloc(`catena::lite::fromProto<${type}>(&value_.get(), value);`, indent+1);
+            bloc('}', indent);
+        };
+        this.params = {
+            "STRUCT": (name, desc, template, indent = 0) => {
+                const info = this.userType(name, desc, template, this.structType);
+                bloc(`${info.fqname} ${name} ${structInit(info.names, info.srctypes, desc)};`, indent);
+                this.paramDefinition(name, desc, template, info.fqname, "STRUCT", indent);
+                this.paramSpecializations(info.fqname, indent);
+            },
+            "STRUCT_ARRAY": (name, desc, template, indent = 0) => {
+                const info = this.userType(name, desc, template, this.structType);
+                const type = `std::vector<${info.fqname}>`;
+                let inits = [];
+                if ("value" in desc) {
+                    for (const structValue of desc.value.struct_array_values.struct_values) {
+                        inits.push(structValueInit(info.names, info.srctypes, structValue));
+                    }
                 }
-                
-                bloc(`const StructInfo& ${fqname}::getStructInfo() {`, bodyIndent);
-                bloc(`static StructInfo t {`, bodyIndent+1);
-                bloc(`"${name}", {`, bodyIndent+2);
-                for (let i = 0; i < n; ++i) {
-                    let indent = bodyIndent+3;
-                    bloc(`{ "${names[i]}", offsetof(${fqname}, ${names[i]}), catena::lite::toProto<${types[i]}>, catena::lite::fromProto<${types[i]}> }${i<n-1?',':''}`, indent);
+                bloc(`${type} ${name}{${inits.join(', ')}};`, indent);
+                this.paramDefinition(name, desc, template, type, "STRUCT_ARRAY", indent);
+                this.paramSpecializations(type, indent);
+            },
+            "STRUCT_VARIANT": (name, desc, template, indent = 0) => {
+                const info = this.userType(name, desc, template, this.variantType);
+                let init = '{}';
+                if ("value" in desc) {
+                    init = ` = ${variantValueInit(info, desc.value.struct_variant_value)}`;
+                }
+                bloc(`${info.fqname} ${name}${init};`, indent);
+                this.paramDefinition(name, desc, template, info.fqname, "STRUCT_VARIANT", indent);
+                this.paramSpecializations(info.fqname, indent);
+            },
+            "STRUCT_VARIANT_ARRAY": (name, desc, template, indent = 0) => {
+                const info = this.userType(name, desc, template, this.variantType);
+                const type = `std::vector<${info.fqname}>`;
+                let inits = [];
+                if ("value" in desc) {
+                    for (const variantValue of desc.value.struct_variant_array_values.struct_variants) {
+                        inits.push(variantValueInit(info, variantValue));
+                    }
                 }
-                bloc(`}`, bodyIndent+2);
-                bloc(`};`, bodyIndent+1);
-                bloc(`return t;`, bodyIndent+1)
-                bloc('}', bodyIndent);
-
-                // instantiate the serialize specialization
-                bloc(`template<>`, indent);
-                bloc(`void catena::lite::Param<${fqname}>::toProto(catena::Value& value) const {`, indent);
-                bloc(`catena::lite::toProto<${fqname}>(value, &value_.get());`, indent+1);
-                bloc('}', indent);
-
-                // instantiate the deserialize specialization
-                bloc(`template<>`, indent);
-                bloc(`void catena::lite::Param<${fqname}>::fromProto(catena::Value& value) {`, indent);
-                bloc(`catena::lite::fromProto<${fqname}>(&value_.get(), value);`, indent+1);
-                bloc('}', indent);
+                bloc(`${type} ${name}{${inits.join(', ')}};`, indent);
+                this.paramDefinition(name, desc, template, type, "STRUCT_VARIANT_ARRAY", indent);
+                this.paramSpecializations(type, indent);
             },
             "STRING": (name, desc, template, indent = 0) => {
                 let initializer = '{}';
@@ -392,7 +544,7 @@ class CppGen {
                     initializer = `{"${desc.value.string_value}"}`;
                 }
                 bloc(`std::string ${name}${initializer};`, indent);
-                bloc(`catena::lite::Param<std::string> ${name}Param(catena::ParamType::STRING,${name},${this.other_items(name, desc, template)},"/${name}",dm);`, indent);
+                this.paramDefinition(name, desc, template, 'std::string', "STRING", indent);
             },
             "INT32": (name, desc, template, indent = 0) => {
                 let initializer = '{}';
@@ -400,7 +552,7 @@ class CppGen {
                     initializer = `{${desc.value.int32_value}}`;
                 }
                 bloc(`int32_t ${name}${initializer};`, indent);
-                bloc(`catena::lite::Param<int32_t> ${name}Param(catena::ParamType::INT32,${name},${this.other_items(name, desc, template)},"/${name}",dm);`, indent);
+                this.paramDefinition(name, desc, template, 'int32_t', "INT32", indent);
             },
             "FLOAT32": (name, desc, template, indent = 0) => {
                 let initializer = '{}';
@@ -408,22 +560,30 @@ class CppGen {
                     initializer = `{${desc.value.float32_value}}`;
                 }
                 bloc(`float ${name}${initializer};`, indent);
-                bloc(`catena::lite::Param<float> ${name}Param(catena::ParamType::FLOAT32,${name},${this.other_items(name, desc, template)},"/${name}",dm);`, indent);
+                this.paramDefinition(name, desc, template, 'float', "FLOAT32", indent);
             },
             "STRING_ARRAY": (name, desc, template, indent = 0) => {
                 let initializer = this.arrayInitializer(name, desc, desc.value.string_array_values.strings, '"', indent);
                 bloc(`std::vector<std::string> ${name}${initializer};`, indent);
-                bloc(`catena::lite::Param<std::vector<std::string>> ${name}Param(catena::ParamType::STRING_ARRAY,${name},${this.other_items(name, desc, template)},"/${name}",dm);`, indent);
+                this.paramDefinition(name, desc, template, 'std::vector<std::string>', "STRING_ARRAY", indent);
             },
             "INT32_ARRAY": (name, desc, template, indent = 0) => {
                 let initializer = this.arrayInitializer(name, desc, desc.value.int32_array_values.ints, '', indent);
                 bloc(`std::vector<std::int32_t> ${name}${initializer};`, indent);
-                bloc(`catena::lite::Param<std::vector<std::int32_t>> ${name}Param(catena::ParamType::INT32_ARRAY,${name},${this.other_items(name, desc, template)},"/${name}",dm);`, indent);
+                this.paramDefinition(name, desc, template, 'std::vector<std::int32_t>', "INT32_ARRAY", indent);
             },
             "FLOAT32_ARRAY": (name, desc, template, indent = 0) => {
                 let initializer = this.arrayInitializer(name, desc, desc.value.float32_array_values.floats, '', indent);
                 bloc(`std::vector<float> ${name}${initializer};`, indent);
-                bloc(`catena::lite::Param<std::vector<float>> ${name}Param(catena::ParamType::FLOAT32_ARRAY,${name},${this.other_items(name, desc, template)},"/${name}",dm);`, indent);
+                this.paramDefinition(name, desc, template, 'std::vector<float>', "FLOAT32_ARRAY", indent);
+            },
+            "BINARY": (name, desc, template, indent = 0) => {
+                bloc(`catena::lite::Blob ${name}{};`, indent);
+                this.paramDefinition(name, desc, template, 'catena::lite::Blob', "BINARY", indent);
+            },
+            "DATA": (name, desc, template, indent = 0) => {
+                bloc(`catena::lite::Blob ${name}{};`, indent);
+                this.paramDefinition(name, desc, template, 'catena::lite::Blob', "DATA", indent);
             }
         };
         this.init = (headerFilename, device) => {
@@ -440,62 +600,95 @@ class CppGen {
             bloc(`#include <lite/include/Param.h>`);
             bloc(`#include <lite/include/Device.h>`);
             bloc(`#include <lite/include/StructInfo.h>`);
+            bloc(`#include <lite/include/Blob.h>`);
             bloc(`#include <lite/include/RangeConstraint.h>`);
             bloc(`#include <lite/include/NamedChoiceConstraint.h>`);
             bloc(`#include <common/include/Enums.h>`);
             bloc(`#include <common/include/IConstraint.h>`);
             bloc(`#include <string>`);
+            bloc(`#include <string_view>`);
+            bloc(`#include <variant>`);
             bloc(`#include <vector>`);
             bloc(`using catena::Device_DetailLevel;`);
             bloc(`using DetailLevel = catena::common::DetailLevel;`);
             bloc(`using catena::common::Scopes_e;`);
             bloc(`using Scope = typename catena::patterns::EnumDecorator<Scopes_e>;`);
             let deviceInit = `${device.slot !== undefined ? device.slot : 0},`;
-            deviceInit += `DetailLevel(${device.detail_level !== undefined ? quoted(device.detail_level) : "FULL"})(),`;
+            deviceInit += `DetailLevel(${quoted(device.detail_level !== undefined ? device.detail_level : "FULL")})(),`;
             if (device.access_scopes !== undefined) {
                 const scopes = device.access_scopes.map(scope => `Scope(${quoted(scope)})()`);
                 deviceInit += `{${scopes.join(',')}},`;
+            } else {
+                deviceInit += `{},`;
             }
-            deviceInit += `Scope(${device.default_scope !== undefined ? quoted(device.default_scope) : "operate"})(),`;
+            deviceInit += `Scope(${quoted(device.default_scope !== undefined ? device.default_scope : "operate")})(),`;
             deviceInit += `${device.multi_set_enabled !== undefined ? device.multi_set_enabled : false},`;
-            deviceInit += `${device.subscriptions !== undefined ? device.subscriptions : false}`;
+            deviceInit += `${device.subscriptions !== undefined ? device.subscriptions : false},`;
+            this.paramCount = device.params !== undefined ? Object.keys(device.params).length : 0;
+            deviceInit += `{&serializeParams,${this.paramCount}}`;
+            bloc(`namespace {`);
+            bloc(`void serializeParams(google::protobuf::Map<std::string, catena::Param>& params);`);
+            bloc(`}`);
             bloc(`catena::lite::Device dm{${deviceInit}};`)
             bloc(`using catena::lite::StructInfo;`);
             bloc(`using catena::lite::FieldInfo;`);
+            bloc(`using catena::lite::VariantInfo;`);
             bloc(`std::unordered_map<std::string, catena::common::IConstraint*> constraints;`);
         },
         this.finish = () => {
+            // the device only uses the serializer if it writes every param
+            if (this.descriptors.size !== this.paramCount) {
+                throw new Error(`Generated ${this.descriptors.size} of the model's ${this.paramCount} params`);
+            }
+            bloc(`namespace {`);
+            this.paramsSerializer();
+            bloc(`}`);
             hloc(`} // namespace ${namespace}`);
         }
     }
     
     param (oid, desc, device) {
-        if (!desc.type in this.params) {
+        if (!(desc.type in this.params)) {
             throw new Error(`No convertor found for ${oid} of type ${desc.type}`);
         }
-        let template_param = undefined;
-        if ("template_oid" in desc) {
-            let template_oid = desc.template_oid.replace(/^\//, '');
-            template_param = device.params[template_oid];
-            if (template_param === undefined) {
-                throw new Error(`Could not find template ${template_oid} for ${oid}`);
-            }
-            if (template_param.type !== desc.type) {
-                throw new Error(`Template ${template_oid} type ${template_param.type} does not match ${oid} type ${desc.type}`);
+        const template_param = this.template(oid, desc, device);
+        if (template_param !== undefined) {
+            // arrays of structs and variants can be based off the type of their elements
+            if (template_param.type !== desc.type && desc.type !== `${template_param.type}_ARRAY`) {
+                throw new Error(`Template ${desc.template_oid} type ${template_param.type} does not match ${oid} type ${desc.type}`);
             }
             if (desc.params !== undefined) {
                 throw new Error(`Param ${oid} is based off a template so it can't have params`);
             }
-        } 
+            desc = inheritTemplate(desc, template_param);
+        }
         return this.params[desc.type](oid, desc, template_param);
     }
 
+    // the template desc is based off, with the fields of its own templates
+    // filled in, or undefined if it has none
+    template (oid, desc, device, seen = new Set()) {
+        if (!("template_oid" in desc)) {
+            return undefined;
+        }
+        const template_oid = desc.template_oid.replace(/^\//, '');
+        const template_param = device.params[template_oid];
+        if (template_param === undefined) {
+            throw new Error(`Could not find template ${template_oid} for ${oid}`);
+        }
+        if (seen.has(template_oid)) {
+            throw new Error(`Template ${template_oid} of ${oid} is based off itself`);
+        }
+        seen.add(template_oid);
+        const base = this.template(template_oid, template_param, device, seen);
+        return base === undefined ? template_param : inheritTemplate(template_param, base);
+    }
+
     constraint (oid, desc) {
-        if (desc.type in this.constraints) {
-            return this.constraints[desc.type](oid, desc);
-        } else {
-            console.log(`No constraint found for ${oid} of type ${desc.type}`);
+        if (!(desc.type in this.constraints)) {
+            throw new Error(`Constraint ${oid} has unsupported type ${desc.type}`);
         }
+        return this.constraints[desc.type](oid, desc);
     }
 };
 